@@ -1,6 +1,7 @@
 // std
 #include <cstdio>
 #include <cstdlib>
+#include <string>
 
 // unix
 #include <unistd.h>
@@ -12,10 +13,19 @@ int main(int argc, char *argv[]) {
     bool dfsaDbg = false;
     bool lexerDbg = false;
     bool parserDbg = false;
+    bool flatDbg = false;
+    PArL::Parser::Mode parserMode =
+        PArL::Parser::Mode::WINDOWED;
+    size_t lexerThreads = 1;
+    bool lazyBodies = false;
+    size_t parserThreads = 1;
+    std::string astPath{};
+    bool loadAst = false;
 
     int opt;
 
-    while ((opt = getopt(argc, argv, "hdlp")) != -1) {
+    while ((opt = getopt(argc, argv, "hdlpftabrj:P:w:")) !=
+           -1) {
         switch (opt) {
             case 'd':
                 dfsaDbg = true;
@@ -26,6 +36,49 @@ int main(int argc, char *argv[]) {
             case 'p':
                 parserDbg = true;
                 break;
+            case 'f':
+                flatDbg = true;
+                break;
+            case 't':
+                parserMode =
+                    PArL::Parser::Mode::TOKEN_STREAM;
+                break;
+            case 'a':
+                parserMode =
+                    PArL::Parser::Mode::PIPELINED;
+                break;
+            case 'b':
+                // deferring bodies needs a token stream
+                lazyBodies = true;
+                parserMode =
+                    PArL::Parser::Mode::TOKEN_STREAM;
+                break;
+            case 'w':
+                astPath = optarg;
+                break;
+            case 'r':
+                loadAst = true;
+                break;
+            case 'j':
+                // lexing in parallel needs a token stream
+                lexerThreads = strtoul(optarg, nullptr, 10);
+                parserMode =
+                    PArL::Parser::Mode::TOKEN_STREAM;
+
+                if (lexerThreads > 0)
+                    break;
+                /* fallthrough */
+            case 'P':
+                // bodies are parsed in parallel once they
+                // have all been left for later
+                parserThreads = strtoul(optarg, nullptr, 10);
+                lazyBodies = true;
+                parserMode =
+                    PArL::Parser::Mode::TOKEN_STREAM;
+
+                if (parserThreads > 0)
+                    break;
+                /* fallthrough */
             case 'h':
                 /* fallthrough */
             default:
@@ -33,8 +86,9 @@ int main(int argc, char *argv[]) {
 
                 fprintf(
                     stderr,
-                    "Usage: %s [-h] [-d] [-l] [-p] "
-                    "[file]\n",
+                    "Usage: %s [-h] [-d] [-l] [-p] [-f] [-t] "
+                    "[-a] [-b] [-j threads] [-P threads] "
+                    "[-w ast] [-r] [file]\n",
                     argv[0]
                 );
                 exit(EXIT_FAILURE);
@@ -51,11 +105,31 @@ int main(int argc, char *argv[]) {
         exit(EXIT_FAILURE);
     }
 
-    PArL::Runner runner(dfsaDbg, lexerDbg, parserDbg);
+    if (loadAst && argc - optind != 1) {
+        fprintf(stderr, "Error: -r needs an ast file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    PArL::Runner runner(
+        dfsaDbg,
+        lexerDbg,
+        parserDbg,
+        flatDbg,
+        parserMode,
+        lexerThreads,
+        lazyBodies,
+        parserThreads,
+        astPath
+    );
 
     if (argc - optind == 1) {
         std::string path(argv[optind]);
 
+        // a saved ast is compiled without lexing or parsing
+        if (loadAst) {
+            return runner.loadFile(path);
+        }
+
         return runner.runFile(path);
     } else {
         return runner.runPrompt();
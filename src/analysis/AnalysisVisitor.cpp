@@ -8,269 +8,327 @@
 #include <backend/Environment.hpp>
 #include <parl/AST.hpp>
 #include <parl/Core.hpp>
+#include <parl/Stack.hpp>
 #include <parl/Token.hpp>
 
 // std
 #include <memory>
+#include <utility>
 
 namespace PArL {
 
-void AnalysisVisitor::visit(core::Type *type) {
+using Kind = core::FlatTree::Kind;
+
+void AnalysisVisitor::visit(core::Type *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::Expr *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::PadWidth *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::PadHeight *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::PadRead *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::PadRandomInt *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::BooleanLiteral *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::IntegerLiteral *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::FloatLiteral *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::ColorLiteral *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::ArrayLiteral *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::Variable *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::ArrayAccess *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::FunctionCall *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::SubExpr *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::Binary *) {
+    core::abort("unimplemented");
+}
+
+void AnalysisVisitor::visit(core::Unary *) {
+    core::abort("unimplemented");
+}
+
+core::Primitive AnalysisVisitor::checkType(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+
     // TODO: add support for more complicated parsing
     // of types (later on maybe during the summer)
-    if (!type->isArray) {
-        mReturn = type->base;
-
-        return;
+    if (node.a == 0) {
+        return core::Primitive{mTree->base(id)};
     }
 
-    if (!type->size) {
+    if (node.b == NO_NODE) {
         error(
-            type->position,
+            node.position,
             "array size must be specified"
         );
     }
 
-    int value = type->size->value;
+    int value = mTree->intValue(node.b);
 
     if (value < 1) {
         error(
-            type->position,
+            node.position,
             "array size must be positive"
         );
     }
 
-    mReturn = core::Array{
+    return core::Primitive{core::Array{
         static_cast<size_t>(value),
-        core::box{core::Primitive{type->base}}
-    };
+        core::box{core::Primitive{mTree->base(id)}}
+    }};
 }
 
-void AnalysisVisitor::visit(core::Expr *expr) {
-    if (expr->type.has_value()) {
-        core::Type *type = (*expr->type).get();
+core::Primitive AnalysisVisitor::checkExpr(
+    core::NodeId id
+) {
+    return core::ensureStack([&] {
+        core::Primitive from = checkUncast(id);
+        core::NodeId cast = mTree->node(id).cast;
 
-        type->accept(this);
+        if (cast == NO_NODE) {
+            return from;
+        }
 
-        mPosition = type->position;
-    }
-}
+        core::Primitive to = checkType(cast);
 
-void AnalysisVisitor::visit(core::PadWidth *expr) {
-    mReturn = core::Base::INT;
-    auto from{mReturn};
+        mPosition = mTree->node(cast).position;
 
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
+        isViableCast(from, to);
 
-    isViableCast(from, to);
+        return to;
+    });
 }
 
-void AnalysisVisitor::visit(core::PadHeight *expr) {
-    mReturn = core::Base::INT;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
+core::Primitive AnalysisVisitor::checkUncast(
+    core::NodeId id
+) {
+    switch (mTree->node(id).kind) {
+        case Kind::PAD_WIDTH:
+        case Kind::PAD_HEIGHT:
+        case Kind::INTEGER_LITERAL:
+            return core::Primitive{core::Base::INT};
+        case Kind::PAD_READ:
+            return checkPadRead(id);
+        case Kind::PAD_RANDOM_INT:
+            return checkPadRandomInt(id);
+        case Kind::BOOLEAN_LITERAL:
+            return core::Primitive{core::Base::BOOL};
+        case Kind::FLOAT_LITERAL:
+            return core::Primitive{core::Base::FLOAT};
+        case Kind::COLOR_LITERAL:
+            return core::Primitive{core::Base::COLOR};
+        case Kind::ARRAY_LITERAL:
+            return checkArrayLiteral(id);
+        case Kind::VARIABLE:
+            return checkVariable(id);
+        case Kind::ARRAY_ACCESS:
+            return checkArrayAccess(id);
+        case Kind::FUNCTION_CALL:
+            return checkFunctionCall(id);
+        case Kind::SUB_EXPR:
+            return checkExpr(mTree->node(id).a);
+        case Kind::BINARY:
+            return checkBinary(id);
+        case Kind::UNARY:
+            return checkUnary(id);
+        default:
+            core::abort("unreachable");
+    }
 
-    isViableCast(from, to);
+    return core::Primitive{};
 }
 
-void AnalysisVisitor::visit(core::PadRead *expr) {
-    expr->x->accept(this);
-    auto xType{mReturn};
+core::Primitive AnalysisVisitor::checkPadRead(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
 
-    expr->y->accept(this);
-    auto yType{mReturn};
+    auto xType{checkExpr(node.a)};
+    auto yType{checkExpr(node.b)};
 
     if (xType != core::Primitive{core::Base::INT}) {
         error(
-            expr->position,
+            node.position,
             "__read expects x to be an integer"
         );
     }
 
     if (yType != core::Primitive{core::Base::INT}) {
         error(
-            expr->position,
+            node.position,
             "__read expects y to be an integer"
         );
     }
 
-    mReturn = core::Base::COLOR;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    return core::Primitive{core::Base::COLOR};
 }
 
-void AnalysisVisitor::visit(core::PadRandomInt *expr) {
-    expr->max->accept(this);
-    auto maxType{mReturn};
+core::Primitive AnalysisVisitor::checkPadRandomInt(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+
+    auto maxType{checkExpr(node.a)};
 
     if (maxType != core::Primitive{core::Base::INT}) {
         error(
-            expr->position,
+            node.position,
             "__random_int expects max to be an integer"
         );
     }
 
-    mReturn = core::Base::INT;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    return core::Primitive{core::Base::INT};
 }
 
-void AnalysisVisitor::visit(core::BooleanLiteral *expr) {
-    mReturn = core::Base::BOOL;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
-}
-
-void AnalysisVisitor::visit(core::IntegerLiteral *expr) {
-    mReturn = core::Base::INT;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
-}
-
-void AnalysisVisitor::visit(core::FloatLiteral *expr) {
-    mReturn = core::Base::FLOAT;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
-}
-
-void AnalysisVisitor::visit(core::ColorLiteral *expr) {
-    mReturn = core::Base::COLOR;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
-}
+core::Primitive AnalysisVisitor::checkArrayLiteral(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+    core::FlatTree::Children exprs = mTree->children(id);
 
-void AnalysisVisitor::visit(core::ArrayLiteral *expr) {
-    if (expr->exprs.empty()) {
-        error(expr->position, "array literal is empty");
+    if (exprs.size() == 0) {
+        error(node.position, "array literal is empty");
     }
 
-    expr->exprs[0]->accept(this);
-    auto initialType{mReturn};
+    auto initialType{checkExpr(exprs[0])};
 
     // NOTE: this is a restriction which we impose on
     // ourselves to increase simplicity later on
     if (initialType.is<core::Array>()) {
         error(
-            expr->position,
+            node.position,
             "nested arrays are not supported"
         );
     }
 
-    for (size_t i = 1; i < expr->exprs.size(); i++) {
-        expr->exprs[i]->accept(this);
+    for (size_t i = 1; i < exprs.size(); i++) {
+        auto type{checkExpr(exprs[i])};
 
-        if (mReturn.is<core::Array>()) {
+        if (type.is<core::Array>()) {
             error(
-                expr->position,
+                node.position,
                 "nested arrays are not supported"
             );
         }
 
-        if (initialType != mReturn) {
+        if (initialType != type) {
             error(
-                expr->position,
+                node.position,
                 "array contains multiple different types"
             );
         }
     }
 
-    mReturn = core::Array{
-        expr->exprs.size(),
+    return core::Primitive{core::Array{
+        exprs.size(),
         core::box{initialType},
-    };
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    }};
 }
 
-void AnalysisVisitor::visit(core::Variable *expr) {
+core::Primitive AnalysisVisitor::checkVariable(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+    core::Atom identifier = mTree->atom(id);
+
     std::optional<Environment *> stoppingEnv =
         findEnclosingEnv(Environment::Type::FUNCTION);
 
     std::optional<Symbol> symbol{findSymbol(
-        expr->identifier,
+        identifier,
         stoppingEnv.has_value() ? *stoppingEnv
                                 : mEnvStack.getGlobal()
     )};
 
     if (!symbol.has_value()) {
         error(
-            expr->position,
+            node.position,
             "{} is undefined",
-            expr->identifier
+            name(identifier)
         );
     }
 
     if (symbol->is<FunctionSymbol>()) {
         error(
-            expr->position,
+            node.position,
             "{}(...) being used as a variable",
-            expr->identifier
+            name(identifier)
         );
     }
 
-    mReturn = symbol->as<VariableSymbol>().type;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    return symbol->as<VariableSymbol>().type;
 }
 
-void AnalysisVisitor::visit(core::ArrayAccess *expr) {
+core::Primitive AnalysisVisitor::checkArrayAccess(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+    core::Atom identifier = mTree->atom(id);
+
     std::optional<Environment *> stoppingEnv =
         findEnclosingEnv(Environment::Type::FUNCTION);
 
     std::optional<Symbol> symbol{findSymbol(
-        expr->identifier,
+        identifier,
         stoppingEnv.has_value() ? *stoppingEnv
                                 : mEnvStack.getGlobal()
     )};
 
     if (!symbol.has_value()) {
         error(
-            expr->position,
+            node.position,
             "{} is undefined",
-            expr->identifier
+            name(identifier)
         );
     }
 
     if (symbol->is<FunctionSymbol>()) {
         error(
-            expr->position,
+            node.position,
             "{}(...) being used as an array",
-            expr->identifier
+            name(identifier)
         );
     }
 
@@ -278,50 +336,48 @@ void AnalysisVisitor::visit(core::ArrayAccess *expr) {
 
     if (!type.is<core::Array>()) {
         error(
-            expr->position,
+            node.position,
             "{} being used as an array",
-            expr->identifier
+            name(identifier)
         );
     }
 
-    expr->index->accept(this);
-    auto indexType{mReturn};
+    auto indexType{checkExpr(node.b)};
 
     if (indexType != core::Primitive{core::Base::INT}) {
         error(
-            expr->position,
+            node.position,
             "array {} indexed with non-integer",
-            expr->identifier
+            name(identifier)
         );
     }
 
-    mReturn = *type.as<core::Array>().type;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    return *type.as<core::Array>().type;
 }
 
-void AnalysisVisitor::visit(core::FunctionCall *expr) {
+core::Primitive AnalysisVisitor::checkFunctionCall(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+    core::Atom identifier = mTree->atom(id);
+
     std::optional<Symbol> symbol{
-        findSymbol(expr->identifier, mEnvStack.getGlobal())
+        findSymbol(identifier, mEnvStack.getGlobal())
     };
 
     if (!symbol.has_value()) {
         error(
-            expr->position,
+            node.position,
             "{}(...) is undefined",
-            expr->identifier
+            name(identifier)
         );
     }
 
     if (!symbol->is<FunctionSymbol>()) {
         error(
-            expr->position,
+            node.position,
             "{} being used as a function",
-            expr->identifier
+            name(identifier)
         );
     }
 
@@ -329,19 +385,17 @@ void AnalysisVisitor::visit(core::FunctionCall *expr) {
 
     std::vector<core::Primitive> paramTypes{};
 
-    for (auto &param : expr->params) {
-        param->accept(this);
-
-        paramTypes.push_back(mReturn);
+    for (core::NodeId param : mTree->list(node.b, node.c)) {
+        paramTypes.push_back(checkExpr(param));
     }
 
     if (funcSymbol.paramTypes.size() != paramTypes.size()) {
         error(
-            expr->position,
+            node.position,
             "function {}(...) received {} parameters, "
             "expected {}",
-            expr->identifier,
-            expr->params.size(),
+            name(identifier),
+            paramTypes.size(),
             funcSymbol.paramTypes.size()
         );
     }
@@ -349,42 +403,28 @@ void AnalysisVisitor::visit(core::FunctionCall *expr) {
     for (int i = 0; i < paramTypes.size(); i++) {
         if (paramTypes[i] != funcSymbol.paramTypes[i]) {
             error(
-                expr->position,
+                node.position,
                 "function {}(...) received parameter "
                 "of unexpected type {}",
-                expr->identifier,
+                name(identifier),
                 core::primitiveToString(&paramTypes[i])
             );
         }
     }
 
-    mReturn = funcSymbol.returnType;
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
-}
-
-void AnalysisVisitor::visit(core::SubExpr *expr) {
-    expr->subExpr->accept(this);
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    return funcSymbol.returnType;
 }
 
-void AnalysisVisitor::visit(core::Binary *expr) {
-    expr->left->accept(this);
-    auto leftType{mReturn};
+core::Primitive AnalysisVisitor::checkBinary(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+    core::Operation op = mTree->operation(id);
 
-    expr->right->accept(this);
-    auto rightType{mReturn};
+    auto leftType{checkExpr(node.a)};
+    auto rightType{checkExpr(node.b)};
 
-    switch (expr->op) {
+    switch (op) {
         case core::Operation::AND:
         case core::Operation::OR:
             if (!(leftType ==
@@ -392,14 +432,13 @@ void AnalysisVisitor::visit(core::Binary *expr) {
                   rightType ==
                       core::Primitive{core::Base::BOOL})) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} expects boolean operands",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
-            mReturn = core::Base::BOOL;
-            break;
+            return core::Primitive{core::Base::BOOL};
         case core::Operation::EQ:
         case core::Operation::GE:
         case core::Operation::GT:
@@ -408,55 +447,53 @@ void AnalysisVisitor::visit(core::Binary *expr) {
         case core::Operation::NEQ:
             if (leftType.is<core::Array>()) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} is not defined on array "
                     "types",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
             if (leftType != rightType) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} expects both operands to "
                     "be of same type",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
-            mReturn = core::Base::BOOL;
-            break;
+            return core::Primitive{core::Base::BOOL};
         case core::Operation::ADD:
         case core::Operation::SUB:
             if (leftType.is<core::Array>()) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} is not defined on array "
                     "types",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
             if (leftType != rightType) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} expects both operands to "
                     "be of same type",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
-            mReturn = leftType;
-            break;
+            return leftType;
         case core::Operation::DIV:
         case core::Operation::MUL:
             if (leftType.is<core::Array>() ||
                 rightType.is<core::Array>()) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} is not defined on array "
                     "types",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
@@ -465,66 +502,63 @@ void AnalysisVisitor::visit(core::Binary *expr) {
                 rightType ==
                     core::Primitive{core::Base::COLOR}) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} is not defined on color "
                     "type",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
             if (leftType != rightType) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} expects both operands to "
                     "be of same type",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
 
-            mReturn = leftType;
-            break;
+            return leftType;
         default:
             core::abort("unreachable");
     }
 
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    return core::Primitive{};
 }
 
-void AnalysisVisitor::visit(core::Unary *expr) {
-    expr->expr->accept(this);
+core::Primitive AnalysisVisitor::checkUnary(
+    core::NodeId id
+) {
+    core::FlatTree::Node const &node = mTree->node(id);
+    core::Operation op = mTree->operation(id);
+
+    auto type{checkExpr(node.a)};
 
-    switch (expr->op) {
+    switch (op) {
         case core::Operation::NOT:
-            if (mReturn !=
-                core::Primitive{core::Base::BOOL}) {
+            if (type != core::Primitive{core::Base::BOOL}) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} expects boolean operand",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
             break;
         case core::Operation::SUB:
-            if (mReturn.is<core::Array>()) {
+            if (type.is<core::Array>()) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} is not defined on array "
                     "types",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
-            if (mReturn ==
-                core::Primitive{core::Base::BOOL}) {
+            if (type == core::Primitive{core::Base::BOOL}) {
                 error(
-                    expr->position,
+                    node.position,
                     "operator {} does not expect "
                     "boolean operand",
-                    core::operationToString(expr->op)
+                    core::operationToString(op)
                 );
             }
             break;
@@ -532,21 +566,15 @@ void AnalysisVisitor::visit(core::Unary *expr) {
             core::abort("unreachable");
     }
 
-    auto from{mReturn};
-
-    expr->core::Expr::accept(this);
-    auto to{mReturn};
-
-    isViableCast(from, to);
+    return type;
 }
 
 void AnalysisVisitor::visit(core::PrintStmt *stmt) {
-    stmt->expr->accept(this);
+    checkExpr(stmt->expr->flatId);
 }
 
 void AnalysisVisitor::visit(core::DelayStmt *stmt) {
-    stmt->expr->accept(this);
-    auto delayType{mReturn};
+    auto delayType{checkExpr(stmt->expr->flatId)};
 
     if (delayType != core::Primitive{core::Base::INT}) {
         error(
@@ -557,20 +585,15 @@ void AnalysisVisitor::visit(core::DelayStmt *stmt) {
 }
 
 void AnalysisVisitor::visit(core::WriteBoxStmt *stmt) {
-    stmt->x->accept(this);
-    auto xType{mReturn};
+    auto xType{checkExpr(stmt->x->flatId)};
 
-    stmt->y->accept(this);
-    auto yType{mReturn};
+    auto yType{checkExpr(stmt->y->flatId)};
 
-    stmt->w->accept(this);
-    auto wType{mReturn};
+    auto wType{checkExpr(stmt->w->flatId)};
 
-    stmt->h->accept(this);
-    auto hType{mReturn};
+    auto hType{checkExpr(stmt->h->flatId)};
 
-    stmt->color->accept(this);
-    auto colorType{mReturn};
+    auto colorType{checkExpr(stmt->color->flatId)};
 
     if (xType != core::Primitive{core::Base::INT}) {
         error(
@@ -609,14 +632,11 @@ void AnalysisVisitor::visit(core::WriteBoxStmt *stmt) {
 }
 
 void AnalysisVisitor::visit(core::WriteStmt *stmt) {
-    stmt->x->accept(this);
-    auto xType{mReturn};
+    auto xType{checkExpr(stmt->x->flatId)};
 
-    stmt->y->accept(this);
-    auto yType{mReturn};
+    auto yType{checkExpr(stmt->y->flatId)};
 
-    stmt->color->accept(this);
-    auto colorType{mReturn};
+    auto colorType{checkExpr(stmt->color->flatId)};
 
     if (xType != core::Primitive{core::Base::INT}) {
         error(
@@ -641,8 +661,7 @@ void AnalysisVisitor::visit(core::WriteStmt *stmt) {
 }
 
 void AnalysisVisitor::visit(core::ClearStmt *stmt) {
-    stmt->color->accept(this);
-    auto colorType{mReturn};
+    auto colorType{checkExpr(stmt->color->flatId)};
 
     if (colorType != core::Primitive{core::Base::COLOR}) {
         error(
@@ -666,7 +685,7 @@ void AnalysisVisitor::visit(core::Assignment *stmt) {
         error(
             stmt->position,
             "{} is undefined",
-            stmt->identifier
+            name(stmt->identifier)
         );
     }
 
@@ -674,20 +693,19 @@ void AnalysisVisitor::visit(core::Assignment *stmt) {
         error(
             stmt->position,
             "{}(...) is being in assignment",
-            stmt->identifier
+            name(stmt->identifier)
         );
     }
 
     if (stmt->index) {
-        stmt->index->accept(this);
-        auto indexType{mReturn};
+        auto indexType{checkExpr(stmt->index->flatId)};
 
         if (!indexType.is<core::Base>() &&
             indexType != core::Primitive{core::Base::INT}) {
             error(
                 stmt->position,
                 "{} indexed with non-integer",
-                stmt->identifier
+                name(stmt->identifier)
             );
         }
     }
@@ -698,7 +716,7 @@ void AnalysisVisitor::visit(core::Assignment *stmt) {
         error(
             stmt->position,
             "{} is not an array",
-            stmt->identifier
+            name(stmt->identifier)
         );
     }
 
@@ -712,15 +730,14 @@ void AnalysisVisitor::visit(core::Assignment *stmt) {
         leftType = *copy;
     }
 
-    stmt->expr->accept(this);
-    auto rightType{mReturn};
+    auto rightType{checkExpr(stmt->expr->flatId)};
 
     if (leftType != rightType) {
         error(
             stmt->position,
             "left-hand side of {} is of type {} whilst "
             "right-hand side is of type {}",
-            stmt->identifier,
+            name(stmt->identifier),
             core::primitiveToString(&leftType),
             core::primitiveToString(&rightType)
         );
@@ -728,8 +745,7 @@ void AnalysisVisitor::visit(core::Assignment *stmt) {
 }
 
 void AnalysisVisitor::visit(core::VariableDecl *stmt) {
-    stmt->type->accept(this);
-    auto leftType{mReturn};
+    auto leftType{checkType(stmt->type->flatId)};
 
     Environment *env = mEnvStack.currentEnv();
 
@@ -737,7 +753,7 @@ void AnalysisVisitor::visit(core::VariableDecl *stmt) {
         error(
             stmt->position,
             "redeclaration of {}",
-            stmt->identifier
+            name(stmt->identifier)
         );
     }
 
@@ -756,7 +772,7 @@ void AnalysisVisitor::visit(core::VariableDecl *stmt) {
                 stmt->position,
                 "redeclaration of {}(...) as a "
                 "variable",
-                stmt->identifier
+                name(stmt->identifier)
             );
         }
 
@@ -765,15 +781,14 @@ void AnalysisVisitor::visit(core::VariableDecl *stmt) {
 
     env->addSymbol(stmt->identifier, {leftType});
 
-    stmt->expr->accept(this);
-    auto rightType{mReturn};
+    auto rightType{checkExpr(stmt->expr->flatId)};
 
     if (leftType != rightType) {
         error(
             stmt->position,
             "left-hand side of {} is of type {} whilst "
             "right-hand side is of type {}",
-            stmt->identifier,
+            name(stmt->identifier),
             core::primitiveToString(&leftType),
             core::primitiveToString(&rightType)
         );
@@ -798,8 +813,7 @@ void AnalysisVisitor::visit(core::IfStmt *stmt) {
     mEnvStack.pushEnv().setType(Environment::Type::IF);
 
     try {
-        stmt->cond->accept(this);
-        auto condType{mReturn};
+        auto condType{checkExpr(stmt->cond->flatId)};
 
         if (condType != core::Primitive{core::Base::BOOL}) {
             error(
@@ -833,8 +847,7 @@ void AnalysisVisitor::visit(core::ForStmt *stmt) {
             stmt->decl->accept(this);
         }
 
-        stmt->cond->accept(this);
-        auto condType{mReturn};
+        auto condType{checkExpr(stmt->cond->flatId)};
 
         if (condType != core::Primitive{core::Base::BOOL}) {
             error(
@@ -850,7 +863,10 @@ void AnalysisVisitor::visit(core::ForStmt *stmt) {
         // noop
     }
 
-    stmt->block->accept(this);
+    // the parser has reported why a body is missing
+    if (stmt->block != nullptr) {
+        stmt->block->accept(this);
+    }
 
     mEnvStack.popEnv();
 }
@@ -859,8 +875,7 @@ void AnalysisVisitor::visit(core::WhileStmt *stmt) {
     mEnvStack.pushEnv().setType(Environment::Type::WHILE);
 
     try {
-        stmt->cond->accept(this);
-        auto condType{mReturn};
+        auto condType{checkExpr(stmt->cond->flatId)};
 
         if (condType != core::Primitive{core::Base::BOOL}) {
             error(
@@ -872,14 +887,16 @@ void AnalysisVisitor::visit(core::WhileStmt *stmt) {
         // noop
     }
 
-    stmt->block->accept(this);
+    // the parser has reported why a body is missing
+    if (stmt->block != nullptr) {
+        stmt->block->accept(this);
+    }
 
     mEnvStack.popEnv();
 }
 
 void AnalysisVisitor::visit(core::ReturnStmt *stmt) {
-    stmt->expr->accept(this);
-    auto exprType{mReturn};
+    auto exprType{checkExpr(stmt->expr->flatId)};
 
     std::optional<Environment *> optEnv =
         findEnclosingEnv(Environment::Type::FUNCTION);
@@ -894,7 +911,7 @@ void AnalysisVisitor::visit(core::ReturnStmt *stmt) {
 
     Environment *env = *optEnv;
 
-    std::string enclosingFunc = env->getName().value();
+    core::Atom enclosingFunc = env->getName().value();
 
     auto funcSymbol = env->getEnclosing()
                           ->findSymbol(enclosingFunc)
@@ -904,14 +921,13 @@ void AnalysisVisitor::visit(core::ReturnStmt *stmt) {
         error(
             stmt->position,
             "incorrect return type in function {}",
-            enclosingFunc
+            name(enclosingFunc)
         );
     }
 }
 
 void AnalysisVisitor::visit(core::FormalParam *param) {
-    param->type->accept(this);
-    auto type{mReturn};
+    auto type{checkType(param->type->flatId)};
 
     Environment *env = mEnvStack.currentEnv();
 
@@ -919,7 +935,7 @@ void AnalysisVisitor::visit(core::FormalParam *param) {
         error(
             param->position,
             "redeclaration of {}",
-            param->identifier
+            name(param->identifier)
         );
     }
 
@@ -938,7 +954,7 @@ void AnalysisVisitor::visit(core::FormalParam *param) {
                 param->position,
                 "redeclaration of {}(...) as a "
                 "parameter",
-                param->identifier
+                name(param->identifier)
             );
         }
 
@@ -962,12 +978,11 @@ void AnalysisVisitor::registerFunction(
     };
 
     for (size_t i = 0; i < paramTypes.size(); i++) {
-        stmt->params[i]->type->accept(this);
-        paramTypes[i] = mReturn;
+        paramTypes[i] =
+            checkType(stmt->params[i]->type->flatId);
     }
 
-    stmt->type->accept(this);
-    auto returnType{mReturn};
+    auto returnType{checkType(stmt->type->flatId)};
 
     Symbol signature =
         FunctionSymbol{std::move(paramTypes), returnType};
@@ -978,29 +993,34 @@ void AnalysisVisitor::registerFunction(
         error(
             stmt->position,
             "redeclaration of {}",
-            stmt->identifier
+            name(stmt->identifier)
         );
     }
 
     env->addSymbol(stmt->identifier, signature);
 
-    if (stmt->identifier == "main") {
+    if (name(stmt->identifier) == "main") {
         error(
             stmt->position,
             "a main function cannot exist",
-            stmt->identifier
+            name(stmt->identifier)
         );
     }
 }
 
 void AnalysisVisitor::visit(core::FunctionDecl *stmt) {
+    if (stmt->block == nullptr && mParseBody &&
+        !mParseBody(stmt)) {
+        throw StopAnalysis{};
+    }
+
     if (!mEnvStack.isCurrentEnvGlobal()) {
         error(
             stmt->position,
             "function declaration {}(...) is not "
             "allowed "
             "here",
-            stmt->identifier
+            name(stmt->identifier)
         );
     }
 
@@ -1016,7 +1036,10 @@ void AnalysisVisitor::visit(core::FunctionDecl *stmt) {
         }
     }
 
-    stmt->block->accept(this);
+    // the parser has reported why a body is missing
+    if (stmt->block != nullptr) {
+        stmt->block->accept(this);
+    }
 
     mEnvStack.popEnv();
 }
@@ -1025,11 +1048,11 @@ void AnalysisVisitor::visit(core::Program *prog) {
     // HACK: this is piece of code to support
     // mutually exclusive recursion such as in test45.parl
     for (auto &stmt : prog->stmts) {
-        if (isFunction.check(stmt.get())) {
+        if (isFunction.check(stmt)) {
             try {
                 registerFunction(
                     dynamic_cast<core::FunctionDecl *>(
-                        stmt.get()
+                        stmt
                     )
                 );
             } catch (SyncAnalysis &) {
@@ -1100,7 +1123,7 @@ void AnalysisVisitor::isViableCast(
 }
 
 std::optional<Symbol> AnalysisVisitor::findSymbol(
-    const std::string &identifier,
+    core::Atom identifier,
     Environment *stoppingEnv
 ) {
     auto *env = mEnvStack.currentEnv();
@@ -1144,10 +1167,36 @@ AnalysisVisitor::getEnvironment() {
     return mEnvStack.extractGlobal();
 }
 
-void AnalysisVisitor::analyse(core::Program *prog) {
-    prog->accept(this);
+void AnalysisVisitor::analyse(
+    core::Tree const &tree,
+    core::LineMap const &lineMap,
+    core::Interner const &interner,
+    BodyParser parseBody
+) {
+    core::Program *prog = tree.get();
+
+    mLineMap = &lineMap;
+    mInterner = &interner;
+    mTree = &tree.flat();
+    mParseBody = std::move(parseBody);
+    mErrors.clear();
 
-    ReturnVisitor returns{};
+    try {
+        prog->accept(this);
+    } catch (StopAnalysis &) {
+        mHasError = true;
+        mErrors.clear();
+
+        return;
+    }
+
+    for (auto const &message : mErrors) {
+        fmt::println(stderr, "{}", message);
+    }
+
+    mErrors.clear();
+
+    ReturnVisitor returns{lineMap, interner};
 
     prog->accept(&returns);
 
@@ -1156,11 +1205,13 @@ void AnalysisVisitor::analyse(core::Program *prog) {
     }
 }
 
+std::string_view AnalysisVisitor::name(core::Atom atom) const {
+    return mInterner->name(atom);
+}
+
 void AnalysisVisitor::reset() {
-    isFunction.reset();
     mHasError = false;
-    mPosition = {0, 0};
-    mReturn = core::Primitive{};
+    mPosition = {0};
     mEnvStack = {};
 }
 
@@ -1,16 +1,32 @@
 #pragma once
 
+// std
+#include <functional>
+#include <string>
+#include <vector>
+
 // parl
 #include <analysis/EnvStack.hpp>
 #include <backend/Environment.hpp>
 #include <backend/Symbol.hpp>
+#include <parl/AST.hpp>
 #include <parl/Core.hpp>
+#include <parl/FlatAST.hpp>
+#include <parl/Interner.hpp>
+#include <parl/LineMap.hpp>
 #include <parl/Visitor.hpp>
 #include <preprocess/IsFunctionVisitor.hpp>
 
 namespace PArL {
 
 class SyncAnalysis : public std::exception {};
+// thrown when a body cannot be parsed, it ends the analysis
+class StopAnalysis : public std::exception {};
+
+// parses the body of a function which a lazy parser left
+// for later, false if it cannot be
+using BodyParser =
+    std::function<bool(core::FunctionDecl *)>;
 
 class AnalysisVisitor : public core::Visitor {
    public:
@@ -48,7 +64,21 @@ class AnalysisVisitor : public core::Visitor {
     void visit(core::Program *) override;
     void reset() override;
 
-    void analyse(core::Program *);
+    // NOTE: a function's body is parsed with parseBody when
+    // the analysis first gets to it, if it has not been
+    // already. A body which does not parse ends the
+    // analysis, as a parsing error would have before it
+    // began, so errors are kept back until every body has
+    // been parsed and dropped if one has not.
+    //
+    // Statements are visited, but the expressions and types
+    // in them are checked by walking the flat tree.
+    void analyse(
+        core::Tree const &,
+        core::LineMap const &,
+        core::Interner const &,
+        BodyParser parseBody = {}
+    );
 
     void registerFunction(core::FunctionDecl *);
 
@@ -58,7 +88,7 @@ class AnalysisVisitor : public core::Visitor {
     );
 
     std::optional<Symbol> findSymbol(
-        const std::string &identifier,
+        core::Atom identifier,
         Environment *stoppingEnv
     );
 
@@ -74,14 +104,19 @@ class AnalysisVisitor : public core::Visitor {
     ) {
         mHasError = true;
 
-        fmt::println(
-            stderr,
+        std::string message = fmt::format(
             "semantic error at {}:{}:: {}",
-            position.row(),
-            position.col(),
+            mLineMap->row(position),
+            mLineMap->col(position),
             fmt::format(fmt, args...)
         );
 
+        if (mParseBody) {
+            mErrors.push_back(std::move(message));
+        } else {
+            fmt::println(stderr, "{}", message);
+        }
+
         throw SyncAnalysis{};
     }
 
@@ -91,10 +126,30 @@ class AnalysisVisitor : public core::Visitor {
     getEnvironment();
 
    private:
+    // each returns the type of what it checks
+    core::Primitive checkType(core::NodeId);
+    core::Primitive checkExpr(core::NodeId);
+    // the type before any cast
+    core::Primitive checkUncast(core::NodeId);
+    core::Primitive checkPadRead(core::NodeId);
+    core::Primitive checkPadRandomInt(core::NodeId);
+    core::Primitive checkArrayLiteral(core::NodeId);
+    core::Primitive checkVariable(core::NodeId);
+    core::Primitive checkArrayAccess(core::NodeId);
+    core::Primitive checkFunctionCall(core::NodeId);
+    core::Primitive checkBinary(core::NodeId);
+    core::Primitive checkUnary(core::NodeId);
+
+    [[nodiscard]] std::string_view name(core::Atom) const;
+
     IsFunctionVisitor isFunction{};
     bool mHasError{false};
-    core::Position mPosition{0, 0};
-    core::Primitive mReturn{};
+    core::Position mPosition{0};
+    core::LineMap const *mLineMap{nullptr};
+    core::Interner const *mInterner{nullptr};
+    core::FlatTree const *mTree{nullptr};
+    BodyParser mParseBody{};
+    std::vector<std::string> mErrors{};
     EnvStack mEnvStack{};
 };
 
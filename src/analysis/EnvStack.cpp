@@ -33,7 +33,7 @@ EnvStack& EnvStack::setType(Environment::Type type) {
     return *this;
 }
 
-EnvStack& EnvStack::setName(std::string const& name) {
+EnvStack& EnvStack::setName(core::Atom name) {
     mCurrent->setName(name);
 
     return *this;
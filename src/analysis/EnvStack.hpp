@@ -14,7 +14,7 @@ class EnvStack {
     EnvStack& popEnv();
 
     EnvStack& setType(Environment::Type type);
-    EnvStack& setName(std::string const& name);
+    EnvStack& setName(core::Atom name);
 
     Environment* currentEnv();
 
@@ -6,6 +6,13 @@
 
 namespace PArL {
 
+ReturnVisitor::ReturnVisitor(
+    core::LineMap const &lineMap,
+    core::Interner const &interner
+)
+    : mLineMap(lineMap), mInterner(interner) {
+}
+
 void ReturnVisitor::visit(core::Type *) {
     core::abort("unimplemented");
 }
@@ -122,8 +129,8 @@ void ReturnVisitor::visit(core::Block *block) {
             start,
             "statements starting from line {} upto line {} "
             "are unreachable",
-            start.row(),
-            block->position.row()
+            mLineMap.row(start),
+            mLineMap.row(block->position)
         );
     }
 
@@ -137,6 +144,13 @@ void ReturnVisitor::visit(core::FormalParam *param) {
 }
 
 void ReturnVisitor::visit(core::FunctionDecl *stmt) {
+    // a body which could not be parsed, or which a lazy
+    // parser left out as the analysis never got to it, is
+    // already an error
+    if (stmt->block == nullptr) {
+        return;
+    }
+
     mBranchReturns = false;
 
     stmt->block->accept(this);
@@ -146,7 +160,7 @@ void ReturnVisitor::visit(core::FunctionDecl *stmt) {
             stmt->position,
             "{}(...) does not return a value in all "
             "control paths",
-            stmt->identifier
+            mInterner.name(stmt->identifier)
         );
     }
 
@@ -2,12 +2,19 @@
 
 // parl
 #include <parl/AST.hpp>
+#include <parl/Interner.hpp>
+#include <parl/LineMap.hpp>
 #include <parl/Visitor.hpp>
 
 namespace PArL {
 
 class ReturnVisitor : public core::Visitor {
    public:
+    ReturnVisitor(
+        core::LineMap const &lineMap,
+        core::Interner const &interner
+    );
+
     void visit(core::Type *) override;
     void visit(core::Expr *) override;
     void visit(core::PadWidth *) override;
@@ -54,8 +61,8 @@ class ReturnVisitor : public core::Visitor {
         fmt::println(
             stderr,
             "semantic warning at {}:{}:: {}",
-            position.row(),
-            position.col(),
+            mLineMap.row(position),
+            mLineMap.col(position),
             fmt::format(fmt, args...)
         );
     }
@@ -71,14 +78,17 @@ class ReturnVisitor : public core::Visitor {
         fmt::println(
             stderr,
             "semantic error at {}:{}:: {}",
-            position.row(),
-            position.col(),
+            mLineMap.row(position),
+            mLineMap.col(position),
             fmt::format(fmt, args...)
         );
     }
 
 
    private:
+    core::LineMap const &mLineMap;
+    core::Interner const &mInterner;
+
     bool mHasError{false};
 
     bool mBranchReturns{false};
@@ -6,6 +6,28 @@
 
 namespace PArL {
 
+// NOTE: scopes nest as deeply as the program does, so rather
+// than have each child destroy its own children in turn the
+// whole subtree is taken apart from a worklist
+
+Environment::~Environment() {
+    std::vector<std::unique_ptr<Environment>> pending =
+        std::move(mChildren);
+
+    while (!pending.empty()) {
+        std::unique_ptr<Environment> env =
+            std::move(pending.back());
+
+        pending.pop_back();
+
+        for (auto& child : env->mChildren) {
+            pending.push_back(std::move(child));
+        }
+
+        env->mChildren.clear();
+    }
+}
+
 Environment* Environment::getEnclosing() const {
     return mEnclosing;
 }
@@ -22,7 +44,7 @@ void Environment::setType(Type type) {
     mType = type;
 }
 
-std::optional<std::string> Environment::getName() const {
+std::optional<core::Atom> Environment::getName() const {
     core::abort_if(
         mType == Type::FUNCTION && !mName.has_value(),
         "function scope must have a name"
@@ -31,7 +53,7 @@ std::optional<std::string> Environment::getName() const {
     return mName;
 }
 
-void Environment::setName(const std::string& name) {
+void Environment::setName(core::Atom name) {
     mName = name;
 }
 
@@ -45,31 +67,31 @@ bool Environment::isGlobal() const {
 }
 
 void Environment::addSymbol(
-    std::string const& identifier,
+    core::Atom identifier,
     Symbol const& symbol
 ) {
     core::abort_if(
         mMap.count(identifier) > 0,
-        "{} is already a registered identifier",
-        identifier
+        "atom {} is already a registered identifier",
+        identifier.id()
     );
 
     mMap.insert({identifier, symbol});
 }
 
 std::optional<Symbol> Environment::findSymbol(
-    std::string const& identifier
+    core::Atom identifier
 ) const {
-    if (mMap.count(identifier) > 0) {
-        return mMap.at(identifier);
+    auto symbol = mMap.find(identifier);
+
+    if (symbol != mMap.end()) {
+        return symbol->second;
     }
 
     return {};
 }
 
-Symbol& Environment::getSymbolAsRef(
-    std::string const& identifier
-) {
+Symbol& Environment::getSymbolAsRef(core::Atom identifier) {
     core::abort_if(
         mMap.count(identifier) <= 0,
         "unchecked access to map"
@@ -2,11 +2,13 @@
 
 // parl
 #include <backend/Symbol.hpp>
+#include <parl/Core.hpp>
 
 // std
+#include <memory>
 #include <optional>
-#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace PArL {
 
@@ -22,14 +24,14 @@ class Environment {
         BLOCK
     };
 
-    void addSymbol(
-        std::string const& identifier,
-        Symbol const& Symbol
-    );
+    Environment() = default;
+    ~Environment();
+
+    void addSymbol(core::Atom identifier, Symbol const& Symbol);
     [[nodiscard]] std::optional<Symbol> findSymbol(
-        std::string const& identifier
+        core::Atom identifier
     ) const;
-    Symbol& getSymbolAsRef(std::string const& identifier);
+    Symbol& getSymbolAsRef(core::Atom identifier);
 
     [[nodiscard]] Environment* getEnclosing() const;
     void setEnclosing(Environment* enclosing);
@@ -37,9 +39,8 @@ class Environment {
     [[nodiscard]] Type getType() const;
     void setType(Type type);
 
-    [[nodiscard]] std::optional<std::string> getName(
-    ) const;
-    void setName(const std::string& name);
+    [[nodiscard]] std::optional<core::Atom> getName() const;
+    void setName(core::Atom name);
 
     std::vector<std::unique_ptr<Environment>>& children();
 
@@ -53,9 +54,10 @@ class Environment {
     void setSize(size_t size);
 
    private:
-    std::unordered_map<std::string, Symbol> mMap{};
+    std::unordered_map<core::Atom, Symbol, core::Atom::Hash>
+        mMap{};
     Type mType{Type::GLOBAL};
-    std::optional<std::string> mName{};
+    std::optional<core::Atom> mName{};
     Environment* mEnclosing{nullptr};
     std::vector<std::unique_ptr<Environment>> mChildren{};
     size_t mSize{0};
@@ -10,7 +10,12 @@
 
 namespace PArL {
 
-GenVisitor::GenVisitor(Environment *global) {
+GenVisitor::GenVisitor(
+    Environment *global,
+    core::FlatTree const &tree,
+    core::Interner const &interner
+)
+    : mType(tree), mInterner(interner) {
     mRefStack.init(global);
 }
 
@@ -177,7 +182,7 @@ void GenVisitor::visit(core::FunctionCall *expr) {
 
     for (auto &param : expr->params) {
         core::Primitive paramType = mType.getType(
-            param.get(),
+            param->flatId,
             mRefStack.getGlobal(),
             mRefStack.currentEnv()
         );
@@ -188,7 +193,10 @@ void GenVisitor::visit(core::FunctionCall *expr) {
     }
 
     emit_line("push {}", size);
-    emit_line("push .{}", expr->identifier);
+    emit_line(
+        "push .{}",
+        mInterner.name(expr->identifier)
+    );
     emit_line("call");
 }
 
@@ -240,7 +248,7 @@ void GenVisitor::visit(core::Binary *expr) {
             break;
         case core::Operation::ADD: {
             core::Primitive type = mType.getType(
-                expr->right.get(),
+                expr->right->flatId,
                 mRefStack.getGlobal(),
                 mRefStack.currentEnv()
             );
@@ -260,7 +268,7 @@ void GenVisitor::visit(core::Binary *expr) {
         } break;
         case core::Operation::SUB: {
             core::Primitive type = mType.getType(
-                expr->right.get(),
+                expr->right->flatId,
                 mRefStack.getGlobal(),
                 mRefStack.currentEnv()
             );
@@ -284,7 +292,7 @@ void GenVisitor::visit(core::Binary *expr) {
             break;
         case core::Operation::DIV: {
             core::Primitive type = mType.getType(
-                expr->right.get(),
+                expr->right->flatId,
                 mRefStack.getGlobal(),
                 mRefStack.currentEnv()
             );
@@ -316,7 +324,7 @@ void GenVisitor::visit(core::Unary *expr) {
             break;
         case core::Operation::SUB: {
             core::Primitive type = mType.getType(
-                expr->expr.get(),
+                expr->expr->flatId,
                 mRefStack.getGlobal(),
                 mRefStack.currentEnv()
             );
@@ -464,7 +472,7 @@ void GenVisitor::visit(core::PrintStmt *stmt) {
     stmt->expr->accept(this);
 
     core::Primitive type = mType.getType(
-        stmt->expr.get(),
+        stmt->expr->flatId,
         mRefStack.getGlobal(),
         mRefStack.currentEnv()
     );
@@ -521,7 +529,7 @@ void GenVisitor::visit(core::Block *block) {
     size_t count = 0;
 
     for (auto &stmt : block->stmts) {
-        count += mDeclCounter.count(stmt.get(), nextEnv);
+        count += mDeclCounter.count(stmt, nextEnv);
     }
 
     emit_line("push {}", count);
@@ -578,10 +586,10 @@ void GenVisitor::visit(core::FunctionDecl *stmt) {
 
     for (auto &stmt : stmt->params) {
         aritySize +=
-            mDeclCounter.count(stmt.get(), nextEnv);
+            mDeclCounter.count(stmt, nextEnv);
     }
 
-    emit_line(".{}", stmt->identifier);
+    emit_line(".{}", mInterner.name(stmt->identifier));
 
     mRefStack.pushEnv(aritySize);
 
@@ -656,7 +664,7 @@ void GenVisitor::visit(core::IfStmt *stmt) {
 
 void GenVisitor::visit(core::ForStmt *stmt) {
     size_t count = stmt->decl ? mDeclCounter.count(
-                                    stmt->decl.get(),
+                                    stmt->decl,
                                     mRefStack.peekNextEnv()
                                 )
                               : 0;
@@ -739,7 +747,7 @@ void GenVisitor::visit(core::Program *prog) {
     auto itr = prog->stmts.begin();
 
     for (; itr != prog->stmts.end(); itr++) {
-        if (isFunction.check(itr->get())) {
+        if (isFunction.check(*itr)) {
             (*itr)->accept(this);
         } else {
             break;
@@ -752,7 +760,7 @@ void GenVisitor::visit(core::Program *prog) {
 
     for (; itr_ != prog->stmts.end(); itr_++) {
         count += mDeclCounter.count(
-            itr_->get(),
+            *itr_,
             mRefStack.currentEnv()
         );
     }
@@ -767,7 +775,7 @@ void GenVisitor::visit(core::Program *prog) {
 
     for (; itr != prog->stmts.end(); itr++) {
         core::abort_if(
-            isFunction.check(itr->get()),
+            isFunction.check(*itr),
             "no function declaration allowed in .main"
         );
 
@@ -842,8 +850,6 @@ size_t GenVisitor::PC() const {
 }
 
 void GenVisitor::reset() {
-    isFunction.reset();
-    mDeclCounter.reset();
     mRefStack.reset();
     mCode.clear();
     mFrameDepth = 0;
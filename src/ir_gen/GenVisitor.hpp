@@ -4,6 +4,7 @@
 #include <ir_gen/RefStack.hpp>
 #include <ir_gen/TypeVisitor.hpp>
 #include <ir_gen/VarDeclCountVisitor.hpp>
+#include <parl/Interner.hpp>
 #include <parl/Visitor.hpp>
 #include <preprocess/IsFunctionVisitor.hpp>
 
@@ -15,7 +16,11 @@ namespace PArL {
 
 class GenVisitor : public core::Visitor {
    public:
-    explicit GenVisitor(Environment *global);
+    GenVisitor(
+        Environment *global,
+        core::FlatTree const &tree,
+        core::Interner const &interner
+    );
 
     void visit(core::Type *) override;
     void visit(core::Expr *) override;
@@ -68,10 +73,12 @@ class GenVisitor : public core::Visitor {
     IsFunctionVisitor isFunction{};
 
     VarDeclCountVisitor mDeclCounter{};
-    TypeVisitor mType{};
+    TypeVisitor mType;
 
     RefStack mRefStack;
 
+    core::Interner const &mInterner;
+
     std::vector<std::string> mCode{};
     size_t mFrameDepth{0};
 };
@@ -1,249 +1,155 @@
 // parl
-#include <ir_gen/TypeVisitor.hpp>
 #include <backend/Environment.hpp>
+#include <ir_gen/TypeVisitor.hpp>
+#include <parl/Stack.hpp>
 
 namespace PArL {
 
-void TypeVisitor::visit(core::Type *type) {
-    if (!type->isArray) {
-        mReturn = type->base;
-
-        return;
-    }
-
-    core::abort_if(
-        !type->size,
-        "emtpy array index cannot be present"
-    );
-
-    int value = type->size->value;
+using Kind = core::FlatTree::Kind;
 
-    core::abort_if(
-        value < 1,
-        "array size must be positive"
-    );
-
-    mReturn = core::Array{
-        static_cast<size_t>(value),
-        core::box{core::Primitive{type->base}}
-    };
+TypeVisitor::TypeVisitor(core::FlatTree const &tree)
+    : mTree(tree), mTypes(tree.size()) {
 }
 
-void TypeVisitor::visit(core::Expr *expr) {
-    if (expr->type.has_value()) {
-        (*expr->type)->accept(this);
-    }
-}
-
-void TypeVisitor::visit(core::PadWidth *expr) {
-    mReturn = core::Base::INT;
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::PadHeight *expr) {
-    mReturn = core::Base::INT;
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::PadRead *expr) {
-    mReturn = core::Base::INT;
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::PadRandomInt *expr) {
-    mReturn = core::Base::INT;
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::BooleanLiteral *expr) {
-    mReturn = core::Base::BOOL;
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::IntegerLiteral *expr) {
-    mReturn = core::Base::INT;
-    expr->core::Expr::accept(this);
-}
+core::Primitive const &TypeVisitor::type(core::NodeId id) {
+    core::Primitive &known = mTypes[id];
 
-void TypeVisitor::visit(core::FloatLiteral *expr) {
-    mReturn = core::Base::FLOAT;
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::ColorLiteral *expr) {
-    mReturn = core::Base::COLOR;
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::ArrayLiteral *expr) {
-    // NOTE: we only need to check the first element
-    // since the rest are guaranteed to be all the
-    // same type due to semantic analysis
-    expr->exprs[0]->accept(this);
-
-    mReturn =
-        core::Array{expr->exprs.size(), core::box{mReturn}};
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::Variable *expr) {
-    std::optional<Environment *> stoppingEnv =
-        findEnclosingEnv(Environment::Type::FUNCTION);
-
-    std::optional<Symbol> symbol{findSymbol(
-        expr->identifier,
-        stoppingEnv.has_value() ? *stoppingEnv
-                                : mRefStack.getGlobal()
-    )};
+    if (!known.is<std::monostate>()) {
+        return known;
+    }
 
-    mReturn = symbol->as<VariableSymbol>().type;
+    core::NodeId cast = mTree.node(id).cast;
+
+    known = core::ensureStack([&] {
+        return typeOf(cast != NO_NODE ? cast : id);
+    });
+
+    return known;
+}
+
+core::Primitive TypeVisitor::typeOf(core::NodeId id) {
+    core::FlatTree::Node const &node = mTree.node(id);
+
+    switch (node.kind) {
+        case Kind::TYPE: {
+            if (node.a == 0) {
+                return core::Primitive{mTree.base(id)};
+            }
+
+            core::abort_if(
+                node.b == NO_NODE,
+                "emtpy array index cannot be present"
+            );
+
+            int value = mTree.intValue(node.b);
+
+            core::abort_if(
+                value < 1,
+                "array size must be positive"
+            );
+
+            return core::Primitive{core::Array{
+                static_cast<size_t>(value),
+                core::box{core::Primitive{mTree.base(id)}}
+            }};
+        }
+        case Kind::PAD_WIDTH:
+        case Kind::PAD_HEIGHT:
+        case Kind::PAD_READ:
+        case Kind::PAD_RANDOM_INT:
+        case Kind::INTEGER_LITERAL:
+            return core::Primitive{core::Base::INT};
+        case Kind::BOOLEAN_LITERAL:
+            return core::Primitive{core::Base::BOOL};
+        case Kind::FLOAT_LITERAL:
+            return core::Primitive{core::Base::FLOAT};
+        case Kind::COLOR_LITERAL:
+            return core::Primitive{core::Base::COLOR};
+        case Kind::ARRAY_LITERAL:
+            // NOTE: we only need to check the first element
+            // since the rest are guaranteed to be all the
+            // same type due to semantic analysis
+            return core::Primitive{core::Array{
+                node.b,
+                core::box{type(mTree.children(id)[0])}
+            }};
+        case Kind::VARIABLE:
+            return variableType(id);
+        case Kind::ARRAY_ACCESS:
+            return *variableType(id)
+                        .as<core::Array>()
+                        .type;
+        case Kind::FUNCTION_CALL: {
+            std::optional<Symbol> symbol{findSymbol(
+                mTree.atom(id),
+                mRefStack.getGlobal()
+            )};
+
+            return symbol->as<FunctionSymbol>().returnType;
+        }
+        case Kind::SUB_EXPR:
+            return type(node.a);
+        case Kind::BINARY:
+            // NOTE: the type of both left and right
+            // expressions are the same
+            switch (mTree.operation(id)) {
+                case core::Operation::AND:
+                case core::Operation::OR:
+                case core::Operation::ADD:
+                case core::Operation::SUB:
+                case core::Operation::MUL:
+                case core::Operation::DIV:
+                    // the type remains the same
+                    return type(node.a);
+                case core::Operation::LT:
+                case core::Operation::GT:
+                case core::Operation::EQ:
+                case core::Operation::NEQ:
+                case core::Operation::LE:
+                case core::Operation::GE:
+                    return core::Primitive{
+                        core::Base::BOOL
+                    };
+                default:
+                    core::abort("unreachable");
+            }
+            break;
+        case Kind::UNARY:
+            // the type remains the same
+            return type(node.a);
+        default:
+            // statements have no type
+            core::abort("unimplemented");
+    }
 
-    expr->core::Expr::accept(this);
+    return core::Primitive{};
 }
 
-void TypeVisitor::visit(core::ArrayAccess *expr) {
+core::Primitive TypeVisitor::variableType(core::NodeId id) {
     std::optional<Environment *> stoppingEnv =
         findEnclosingEnv(Environment::Type::FUNCTION);
 
     std::optional<Symbol> symbol{findSymbol(
-        expr->identifier,
+        mTree.atom(id),
         stoppingEnv.has_value() ? *stoppingEnv
                                 : mRefStack.getGlobal()
     )};
 
-    mReturn = *symbol->as<VariableSymbol>()
-                   .type.as<core::Array>()
-                   .type;
-
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::FunctionCall *expr) {
-    std::optional<Symbol> symbol{
-        findSymbol(expr->identifier, mRefStack.getGlobal())
-    };
-
-    mReturn = symbol->as<FunctionSymbol>().returnType;
-
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::SubExpr *expr) {
-    expr->subExpr->accept(this);
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::Binary *expr) {
-    // NOTE: the type of both left and right expressions
-    // are the same
-    expr->right->accept(this);
-    expr->left->accept(this);
-
-    switch (expr->op) {
-        case core::Operation::AND:
-        case core::Operation::OR:
-            // mReturn remains the same
-            break;
-        case core::Operation::LT:
-        case core::Operation::GT:
-        case core::Operation::EQ:
-        case core::Operation::NEQ:
-        case core::Operation::LE:
-        case core::Operation::GE:
-            mReturn = core::Base::BOOL;
-            break;
-        case core::Operation::ADD:
-        case core::Operation::SUB:
-        case core::Operation::MUL:
-        case core::Operation::DIV:
-            // mReturn remains the same
-            break;
-        default:
-            core::abort("unreachable");
-    }
-
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::Unary *expr) {
-    expr->expr->accept(this);
-
-    switch (expr->op) {
-        case core::Operation::NOT:
-            // mReturn remains the same
-            break;
-        case core::Operation::SUB:
-            // mReturn remains the same
-            break;
-        default:
-            core::abort("unreachable");
-    }
-
-    expr->core::Expr::accept(this);
-}
-
-void TypeVisitor::visit(core::Assignment *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::VariableDecl *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::PrintStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::DelayStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::WriteBoxStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::WriteStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::ClearStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::Block *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::FormalParam *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::FunctionDecl *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::IfStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::ForStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::WhileStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::ReturnStmt *) {
-    core::abort("unimplemented");
-}
-void TypeVisitor::visit(core::Program *) {
-    core::abort("unimplemented");
+    return symbol->as<VariableSymbol>().type;
 }
 
 void TypeVisitor::reset() {
     mRefStack.reset();
-
-    mReturn = std::monostate{};
 }
 
 core::Primitive TypeVisitor::getType(
-    core::Node *node,
+    core::NodeId id,
     Environment *global,
     Environment *current
 ) {
     mRefStack.init(global, current);
 
-    node->accept(this);
-
-    auto result = mReturn;
+    core::Primitive result = type(id);
 
     reset();
 
@@ -251,7 +157,7 @@ core::Primitive TypeVisitor::getType(
 }
 
 std::optional<Symbol> TypeVisitor::findSymbol(
-    const std::string &identifier,
+    core::Atom identifier,
     Environment *stoppingEnv
 ) {
     auto *env = mRefStack.currentEnv();
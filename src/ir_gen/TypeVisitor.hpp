@@ -1,60 +1,36 @@
 #pragma once
 
+// std
+#include <optional>
+#include <vector>
+
 // parl
 #include <ir_gen/RefStack.hpp>
-#include <parl/AST.hpp>
 #include <parl/Core.hpp>
-#include <parl/Visitor.hpp>
+#include <parl/FlatAST.hpp>
 
 namespace PArL {
 
-class TypeVisitor : public core::Visitor {
+// NOTE: types expressions by walking the flat tree. The
+// type of an expression only depends on it and the scope it
+// is in, which is always the same, so each is worked out
+// once and kept by the id of its node, and the operands of
+// an operator are not typed again for the operator.
+
+class TypeVisitor {
    public:
-    // expression types
-    void visit(core::Type *) override;
-    void visit(core::Expr *) override;
-    void visit(core::PadWidth *) override;
-    void visit(core::PadHeight *) override;
-    void visit(core::PadRead *) override;
-    void visit(core::PadRandomInt *) override;
-    void visit(core::BooleanLiteral *) override;
-    void visit(core::IntegerLiteral *) override;
-    void visit(core::FloatLiteral *) override;
-    void visit(core::ColorLiteral *) override;
-    void visit(core::ArrayLiteral *) override;
-    void visit(core::Variable *) override;
-    void visit(core::ArrayAccess *) override;
-    void visit(core::FunctionCall *) override;
-    void visit(core::SubExpr *) override;
-    void visit(core::Binary *) override;
-    // statement types
-    void visit(core::Unary *) override;
-    void visit(core::Assignment *) override;
-    void visit(core::VariableDecl *) override;
-    void visit(core::PrintStmt *) override;
-    void visit(core::DelayStmt *) override;
-    void visit(core::WriteBoxStmt *) override;
-    void visit(core::WriteStmt *) override;
-    void visit(core::ClearStmt *) override;
-    void visit(core::Block *) override;
-    void visit(core::FormalParam *) override;
-    void visit(core::FunctionDecl *) override;
-    void visit(core::IfStmt *) override;
-    void visit(core::ForStmt *) override;
-    void visit(core::WhileStmt *) override;
-    void visit(core::ReturnStmt *) override;
-    void visit(core::Program *) override;
+    explicit TypeVisitor(core::FlatTree const &tree);
 
-    void reset() override;
+    void reset();
 
     core::Primitive getType(
-        core::Node *node,
+        core::NodeId id,
         Environment *global,
         Environment *current
     );
 
     std::optional<Symbol> findSymbol(
-        const std::string &identifier,
+        core::Atom identifier,
         Environment *stoppingEnv
     );
 
@@ -63,7 +39,14 @@ class TypeVisitor : public core::Visitor {
     );
 
    private:
-    core::Primitive mReturn{};
+    // an expression cast to a type has that type instead
+    core::Primitive const &type(core::NodeId id);
+    core::Primitive typeOf(core::NodeId id);
+    core::Primitive variableType(core::NodeId id);
+
+    core::FlatTree const &mTree;
+    // nothing for an expression not typed yet
+    std::vector<core::Primitive> mTypes;
     RefStack mRefStack;
 };
 
@@ -10,58 +10,57 @@ namespace PArL {
 
 Dfsa::Dfsa(
     size_t noOfStates,
-    size_t noOfCategories,
-    std::vector<std::vector<int>> const& transitionTable,
+    size_t noOfClasses,
+    std::array<uint8_t, NO_OF_BYTES> const& byteClasses,
+    std::vector<int16_t> const& transitionTable,
     int initialState,
-    std::unordered_set<int> const& finalStates
+    std::vector<bool> const& finalStates
 )
     : mNoOfStates(noOfStates),
-      mNoOfCategories(noOfCategories),
+      mNoOfClasses(noOfClasses),
+      mByteClasses(byteClasses),
       mTransitionTable(transitionTable),
       mInitialState(initialState),
       mFinalStates(finalStates) {
-}
+    core::abort_if(
+        mTransitionTable.size() != noOfStates * noOfClasses,
+        "transition table must have {} entries",
+        noOfStates * noOfClasses
+    );
 
-int Dfsa::getInitialState() const {
-    return mInitialState;
+    for (uint8_t byteClass : mByteClasses) {
+        core::abort_if(
+            byteClass >= noOfClasses,
+            "byte class {} does not exist",
+            byteClass
+        );
+    }
+    core::abort_if(
+        mFinalStates.size() != noOfStates,
+        "final state set must have {} entries",
+        noOfStates
+    );
+    core::abort_if(
+        !isValidState(initialState),
+        "initial state {} does not exist",
+        initialState
+    );
 }
 
-bool Dfsa::isValidState(int state) const {
-    return 0 <= state && state < mNoOfStates;
+size_t Dfsa::getNoOfStates() const {
+    return mNoOfStates;
 }
 
-bool Dfsa::isValidCategory(int category) const {
-    return 0 <= category && category < mNoOfCategories;
+size_t Dfsa::getNoOfClasses() const {
+    return mNoOfClasses;
 }
 
-bool Dfsa::isFinalState(int state) const {
-    return mFinalStates.count(state) > 0;
+int Dfsa::getInitialState() const {
+    return mInitialState;
 }
 
-int Dfsa::getTransition(
-    int state,
-    std::vector<int> const& categories
-) const {
-    core::abort_if(
-        !isValidState(state),
-        "state {} does not exist",
-        state
-    );
-
-    for (auto const& category : categories) {
-        core::abort_if(
-            !isValidCategory(category),
-            "category {} does not exist",
-            category
-        );
-        int nextState = mTransitionTable[state][category];
-
-        if (nextState != INVALID_STATE) {
-            return nextState;
-        }
-    }
-
-    return INVALID_STATE;
+bool Dfsa::isValidState(int state) const {
+    return 0 <= state && state < mNoOfStates;
 }
 
 }  // namespace PArL
@@ -1,11 +1,14 @@
 #pragma once
 
 // std
-#include <unordered_set>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 // macro definitions
 #define INVALID_STATE (-1)
+#define NO_OF_BYTES (256)
 
 namespace PArL {
 
@@ -15,32 +18,45 @@ class Dfsa {
    public:
     Dfsa(
         size_t noOfStates,
-        size_t noOfCategories,
-        std::vector<std::vector<int>> const&
-            transitionTable,
+        size_t noOfClasses,
+        std::array<uint8_t, NO_OF_BYTES> const& byteClasses,
+        std::vector<int16_t> const& transitionTable,
         int initialState,
-        std::unordered_set<int> const& finalStates
+        std::vector<bool> const& finalStates
     );
 
+    [[nodiscard]] size_t getNoOfStates() const;
+
+    [[nodiscard]] size_t getNoOfClasses() const;
+
     [[nodiscard]] int getInitialState() const;
 
     [[nodiscard]] bool isValidState(int state) const;
-    [[nodiscard]] bool isValidCategory(int category) const;
-
-    [[nodiscard]] bool isFinalState(int state) const;
 
-    [[nodiscard]] int getTransition(
-        int state,
-        std::vector<int> const& categories
-    ) const;
+    [[nodiscard]] bool isFinalState(int state) const {
+        return mFinalStates[state];
+    }
+
+    // NOTE: bytes which behave the same in every state share
+    // a class, so the table has a column per class rather
+    // than per byte and stays small enough to sit in L1. A
+    // transition is two loads, the state is assumed to be
+    // valid.
+    [[nodiscard]] int getTransition(int state, char byte)
+        const {
+        return mTransitionTable
+            [state * mNoOfClasses +
+             mByteClasses[static_cast<unsigned char>(byte)]];
+    }
 
    private:
-    const size_t mNoOfStates;      // Q
-    const size_t mNoOfCategories;  // Sigma
-    const std::vector<std::vector<int>>
-        mTransitionTable;                        // delta
-    const int mInitialState;                     // q_0
-    const std::unordered_set<int> mFinalStates;  // F
+    const size_t mNoOfStates;   // Q
+    const size_t mNoOfClasses;  // Sigma, as byte classes
+    const std::array<uint8_t, NO_OF_BYTES> mByteClasses;
+    const std::vector<int16_t>
+        mTransitionTable;                  // delta
+    const int mInitialState;               // q_0
+    const std::vector<bool> mFinalStates;  // F
 };
 
 }  // namespace PArL
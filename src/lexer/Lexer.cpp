@@ -2,7 +2,12 @@
 #include <fmt/core.h>
 
 // std
-#include <stack>
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <utility>
 
 // parl
@@ -15,191 +20,576 @@ namespace PArL {
 
 Lexer::Lexer(
     Dfsa dfsa,
-    std::unordered_map<int, std::function<bool(char)>>
-        categoryToChecker,
-    std::unordered_map<int, Token::Type>
-        finalStateToTokenType
+    std::vector<Token::Type> tokenTypes,
+    std::vector<std::optional<Value>> tokenValues
 )
     : mDfsa(std::move(dfsa)),
-      mCategoryToChecker(std::move(categoryToChecker)),
-      mFinalStateToTokenType(std::move(finalStateToTokenType
-      )) {
+      mTokenTypes(std::move(tokenTypes)),
+      mTokenValues(std::move(tokenValues)) {
+    size_t noOfStates = mDfsa.getNoOfStates();
+
+    mTokenTypes.resize(noOfStates, Token::Type::END_OF_FILE);
+    mTokenValues.resize(noOfStates);
+    mTriviaStates.resize(noOfStates, false);
+
+    for (size_t state = 0; state < noOfStates; state++) {
+        if (!mDfsa.isFinalState(static_cast<int>(state)))
+            continue;
+
+        mTriviaStates[state] =
+            mTokenTypes[state] == Token::Type::WHITESPACE ||
+            mTokenTypes[state] == Token::Type::COMMENT;
+    }
+
+    initSpanScanners();
+}
+
+// NOTE: trivia states are not necessarily final (the body
+// of a block comment is not), so every state from which a
+// trivia state can be reached without passing through the
+// initial state is given a scanner if it loops on itself
+
+void Lexer::initSpanScanners() {
+    size_t noOfStates = mDfsa.getNoOfStates();
+    auto initialState =
+        static_cast<size_t>(mDfsa.getInitialState());
+
+    std::vector<bool> isTriviaPath(noOfStates, false);
+
+    for (size_t state = 0; state < noOfStates; state++) {
+        isTriviaPath[state] = mTriviaStates[state];
+    }
+
+    // propagate backwards until a fixed point is reached
+    bool updated = true;
+
+    while (updated) {
+        updated = false;
+
+        for (size_t state = 0; state < noOfStates; state++) {
+            if (isTriviaPath[state] || state == initialState)
+                continue;
+
+            for (int byte = 0; byte < NO_OF_BYTES; byte++) {
+                int next = mDfsa.getTransition(
+                    static_cast<int>(state),
+                    static_cast<char>(byte)
+                );
+
+                if (next != INVALID_STATE &&
+                    isTriviaPath[next]) {
+                    isTriviaPath[state] = true;
+                    updated = true;
+
+                    break;
+                }
+            }
+        }
+    }
+
+    mSpanScanners.resize(noOfStates);
+
+    for (size_t state = 0; state < noOfStates; state++) {
+        if (!isTriviaPath[state])
+            continue;
+
+        std::bitset<NO_OF_BYTES> loops{};
+
+        for (int byte = 0; byte < NO_OF_BYTES; byte++) {
+            int next = mDfsa.getTransition(
+                static_cast<int>(state),
+                static_cast<char>(byte)
+            );
+
+            loops[byte] = next != INVALID_STATE &&
+                          static_cast<size_t>(next) == state;
+        }
+
+        if (loops.any())
+            mSpanScanners[state] = SpanScanner::fromSet(loops);
+    }
 }
 
 void Lexer::reset() {
     mCursor = 0;
-    mLine = 1;
-    mColumn = 1;
     mHasError = false;
-    mSource.clear();
+    mDeferredError.reset();
+    mWindow = {};
+    mWindowBuffer.clear();
+    mWindowBase = 0;
+    mStream = nullptr;
+    mRetiredWindows.clear();
+    mLineMap.clear();
 }
 
-void Lexer::addSource(std::string const& source) {
+void Lexer::addSource(std::string_view source) {
     reset();
 
-    mSource = source;
+    core::abort_if(
+        source.length() > UINT32_MAX,
+        "sources larger than {} bytes are not supported",
+        UINT32_MAX
+    );
+
+    mWindow = source;
+
+    mLineMap.build(source);
+}
+
+void Lexer::addStream(std::istream& stream) {
+    reset();
+
+    mStream = &stream;
+}
+
+void Lexer::release(core::Position position) {
+    while (!mRetiredWindows.empty() &&
+           mRetiredWindows.front().first <=
+               position.offset()) {
+        mRetiredWindows.pop_front();
+    }
+}
+
+void Lexer::setMode(Mode mode) {
+    mMode = mode;
+}
+
+void Lexer::setInterner(core::Interner* interner) {
+    mInterner = interner;
+}
+
+void Lexer::setDeferErrors(bool defer) {
+    mDeferErrors = defer;
+}
+
+std::optional<std::string> Lexer::takeError() {
+    std::optional<std::string> error{};
+
+    std::swap(error, mDeferredError);
+
+    return error;
 }
 
 std::optional<Token> Lexer::nextToken() {
-    if (isAtEnd(0))
-        return Token{
-            mLine,
-            mColumn,
-            "",
-            Token::Type::END_OF_FILE
-        };
+    int state;
+    std::string_view lexeme;
 
-    auto [state, lexeme] = simulateDFSA();
+    for (;;) {
+        if (isAtEnd())
+            return Token{
+                currentPosition(),
+                "",
+                Token::Type::END_OF_FILE
+            };
 
-    std::optional<Token> token{};
+        std::tie(state, lexeme) = simulateDFSA();
 
-    if (state == INVALID_STATE) {
-        mHasError = true;
-
-        fmt::println(
-            stderr,
-            "lexical error at {}:{}:: unexpected "
-            "lexeme '{}'",
-            mLine,
-            mColumn,
-            lexeme
+        if (mMode == Mode::PRESERVE_TRIVIA ||
+            state == INVALID_STATE || !isTrivia(state))
+            break;
+
+        mCursor += lexeme.length();
+    }
+
+    Lexeme lexed = createLexeme(mCursor, lexeme, state);
+
+    mCursor += lexeme.length();
+
+    if (lexed.error.has_value())
+        report(std::move(*lexed.error));
+
+    if (lexed.token.has_value())
+        return intern(*lexed.token);
+
+    return {};
+}
+
+std::vector<Token> Lexer::lexParallel(size_t noOfThreads) {
+    core::abort_if(
+        mStream != nullptr,
+        "streams cannot be lexed in parallel"
+    );
+
+    size_t begin = mCursor;
+    size_t end = mWindow.size();
+
+    // small chunks are not worth a thread
+    size_t noOfChunks = std::min(
+        noOfThreads,
+        (end - begin) / MIN_PARALLEL_CHUNK_SIZE
+    );
+
+    noOfChunks = std::max<size_t>(noOfChunks, 1);
+
+    // every chunk but the first starts just after a newline
+    std::vector<size_t> starts{begin};
+
+    for (size_t i = 1; i < noOfChunks; i++) {
+        size_t target =
+            begin + (end - begin) * i / noOfChunks;
+        size_t newline = mWindow.find(
+            '\n',
+            std::max(target, starts.back())
         );
-    } else {
-        try {
-            token = createToken(
-                lexeme,
-                mFinalStateToTokenType.at(state)
-            );
-        } catch (UndefinedBuiltin& error) {
-            mHasError = true;
-
-            fmt::println(
-                stderr,
-                "lexical error at {}:{}:: {}",
-                mLine,
-                mColumn,
-                error.what()
+
+        if (newline == std::string_view::npos ||
+            newline + 1 == end)
+            break;
+
+        starts.push_back(newline + 1);
+    }
+
+    std::vector<Chunk> chunks(starts.size());
+    std::vector<std::thread> threads{};
+
+    for (size_t i = 1; i < starts.size(); i++) {
+        threads.emplace_back([&, i]() {
+            chunks[i] = lexChunk(
+                starts[i],
+                i + 1 < starts.size() ? starts[i + 1] : end
             );
+        });
+    }
+
+    chunks[0] = lexChunk(
+        begin,
+        starts.size() > 1 ? starts[1] : end
+    );
+
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<Token> tokens{};
+
+    auto emit = [&](Lexeme& lexed) {
+        if (lexed.error.has_value())
+            report(std::move(*lexed.error));
+
+        if (lexed.token.has_value())
+            tokens.push_back(intern(*lexed.token));
+    };
+
+    size_t offset = begin;
+
+    for (size_t i = 0; i < chunks.size(); i++) {
+        std::vector<Lexeme>& lexemes = chunks[i].lexemes;
+
+        size_t next = 0;
+        bool isInSync = offset == starts[i];
+
+        // the previous chunk ran into this one
+        while (!isInSync && offset < chunks[i].end) {
+            std::optional<Lexeme> lexed = lexAt(offset);
+
+            if (!lexed.has_value())
+                break;
+
+            while (next < lexemes.size() &&
+                   lexemes[next].offset < lexed->offset)
+                next++;
+
+            isInSync =
+                next < lexemes.size() &&
+                lexemes[next].offset == lexed->offset;
+
+            if (!isInSync)
+                emit(*lexed);
         }
+
+        if (!isInSync)
+            continue;
+
+        for (; next < lexemes.size(); next++)
+            emit(lexemes[next]);
+
+        offset = chunks[i].end;
     }
 
-    updateLocationState(lexeme);
+    mCursor = offset;
 
-    return token;
+    tokens.emplace_back(
+        currentPosition(),
+        "",
+        Token::Type::END_OF_FILE
+    );
+
+    return tokens;
 }
 
 Dfsa const& Lexer::getDfsa() const {
     return mDfsa;
 }
 
+core::LineMap const& Lexer::getLineMap() const {
+    return mLineMap;
+}
+
 bool Lexer::hasError() const {
     return mHasError;
 }
 
-Token Lexer::createToken(
-    std::string const& lexeme,
-    Token::Type type
-) const {
-    return Token{mLine, mColumn, lexeme, type};
-}
+void Lexer::report(std::string message) {
+    mHasError = true;
 
-bool Lexer::isAtEnd(size_t offset) const {
-    return mCursor + offset >= mSource.length();
+    if (mDeferErrors) {
+        mDeferredError = std::move(message);
+    } else {
+        fmt::println(stderr, "{}", message);
+    }
 }
 
-void Lexer::updateLocationState(std::string const& lexeme) {
-    for (char ch : lexeme) {
-        mCursor++;
-
-        if (ch == '\n') {
-            mLine++;
+Lexer::Lexeme Lexer::createLexeme(
+    size_t offset,
+    std::string_view lexeme,
+    int state
+) const {
+    Lexeme lexed{offset};
+    core::Position position{static_cast<uint32_t>(offset)};
 
-            mColumn = 1;
-        } else {
-            mColumn++;
+    if (state == INVALID_STATE) {
+        lexed.error = formatError(
+            position,
+            "unexpected lexeme '{}'",
+            lexeme
+        );
+    } else {
+        try {
+            lexed.token =
+                createToken(position, lexeme, state);
+        } catch (UndefinedBuiltin& error) {
+            lexed.error =
+                formatError(position, "{}", error.what());
         }
     }
+
+    return lexed;
 }
 
-std::optional<char> Lexer::nextCharacter(size_t cursor
+Token Lexer::createToken(
+    core::Position position,
+    std::string_view lexeme,
+    int state
 ) const {
-    if (!isAtEnd(cursor))
-        return mSource[mCursor + cursor];
+    if (mTokenValues[state].has_value()) {
+        return Token{
+            position,
+            lexeme,
+            mTokenTypes[state],
+            *mTokenValues[state]
+        };
+    }
 
-    return {};
+    return Token{position, lexeme, mTokenTypes[state]};
 }
 
-std::vector<int> Lexer::categoriesOf(char character) const {
-    std::vector<int> satisfiedCategories{};
+Token Lexer::intern(Token const& token) {
+    if (token.getType() != Token::Type::IDENTIFIER ||
+        mInterner == nullptr)
+        return token;
+
+    return Token{
+        token.getPosition(),
+        token.getLexeme(),
+        Token::Type::IDENTIFIER,
+        Value{mInterner->intern(token.getLexeme())}
+    };
+}
 
-    for (auto& [category, check] : mCategoryToChecker) {
-        if (check(character))
-            satisfiedCategories.emplace_back(category);
+std::optional<Lexer::Lexeme> Lexer::lexAt(size_t& offset
+) const {
+    while (offset < mWindow.size()) {
+        std::string_view input = mWindow.substr(offset);
+
+        Scan scan{mDfsa.getInitialState()};
+
+        runDfsa(input, scan);
+
+        auto [state, lexeme] = munch(input, scan);
+
+        size_t start = offset;
+
+        offset += lexeme.length();
+
+        if (mMode == Mode::SKIP_TRIVIA &&
+            state != INVALID_STATE && isTrivia(state))
+            continue;
+
+        return createLexeme(start, lexeme, state);
     }
 
-    return satisfiedCategories;
+    return {};
 }
 
-std::pair<int, std::string> Lexer::simulateDFSA() {
-    int state = mDfsa.getInitialState();
+Lexer::Chunk Lexer::lexChunk(size_t begin, size_t end)
+    const {
+    Chunk chunk{};
 
-    size_t lCursor = 0;  // local cursor
+    size_t offset = begin;
 
-    std::stack<int> stack;
+    while (offset < end) {
+        std::optional<Lexeme> lexed = lexAt(offset);
 
-    std::string lexeme;
+        if (!lexed.has_value())
+            break;
 
-    for (;;) {
-        if (mDfsa.isFinalState(state)) {
-            while (!stack.empty()) {
-                stack.pop();
-            }
-        }
+        chunk.lexemes.push_back(std::move(*lexed));
+    }
+
+    chunk.end = offset;
+
+    return chunk;
+}
 
-        stack.push(state);
+bool Lexer::isTrivia(int state) const {
+    return mTriviaStates[state];
+}
+
+bool Lexer::isAtEnd() {
+    return mCursor >= mWindowBase + mWindow.size() &&
+           !refill();
+}
 
-        std::optional<char> ch = nextCharacter(lCursor);
+std::string_view Lexer::window() const {
+    return mWindow.substr(mCursor - mWindowBase);
+}
+
+// NOTE: when streaming, a new window is started from the
+// lexeme being scanned followed by the next chunk of the
+// stream. The previous window is not freed straight away
+// since tokens handed out earlier still view into it, it
+// is retired until a position at or past the start of the
+// new window is released. Moving a vector keeps its buffer
+// in place, so those views stay valid.
 
-        if (!ch.has_value())
-            break;  // end of file
+bool Lexer::refill() {
+    if (mStream == nullptr)
+        return false;
 
-        std::vector<int> categories =
-            categoriesOf(ch.value());
+    size_t carried = mWindowBase + mWindow.size() - mCursor;
 
-        state = !categories.empty()
-                    ? mDfsa.getTransition(state, categories)
-                    : INVALID_STATE;
+    std::vector<char> window{};
 
-        if (state == INVALID_STATE)
-            break;  // no more transitions are available
+    window.reserve(carried + STREAM_CHUNK_SIZE);
+    window.insert(
+        window.end(),
+        mWindow.end() - carried,
+        mWindow.end()
+    );
+    window.resize(carried + STREAM_CHUNK_SIZE);
 
-        lCursor++;
+    mStream->read(window.data() + carried, STREAM_CHUNK_SIZE);
 
-        lexeme += ch.value();
+    auto read = static_cast<size_t>(mStream->gcount());
+
+    if (read == 0) {
+        mStream = nullptr;
+
+        return false;
     }
 
+    window.resize(carried + read);
+
+    size_t end = mWindowBase + mWindow.size();
+
     core::abort_if(
-        stack.empty(),
-        "stack should never be emtpy"
+        end + read > UINT32_MAX,
+        "sources larger than {} bytes are not supported",
+        UINT32_MAX
     );
 
-    for (;;) {
-        state = stack.top();
+    mLineMap.append(
+        std::string_view{window.data() + carried, read},
+        static_cast<uint32_t>(end)
+    );
 
-        stack.pop();
+    if (mCursor > mWindowBase) {
+        mRetiredWindows.emplace_back(
+            mCursor,
+            std::move(mWindowBuffer)
+        );
+    }
 
-        if (mDfsa.isFinalState(state))
-            return {state, lexeme};
+    mWindowBuffer = std::move(window);
+    mWindow = {mWindowBuffer.data(), mWindowBuffer.size()};
+    mWindowBase = mCursor;
 
-        if (stack.empty())
+    return true;
+}
+
+core::Position Lexer::currentPosition() const {
+    return {static_cast<uint32_t>(mCursor)};
+}
+
+// NOTE: maximal munch only needs to remember the last
+// accepting state and the length at which it was reached,
+// backtracking is then just a matter of slicing the source
+
+std::pair<int, std::string_view> Lexer::simulateDFSA() {
+    std::string_view input = window();
+
+    Scan scan{mDfsa.getInitialState()};
+
+    for (;;) {
+        runDfsa(input, scan);
+
+        // no more transitions are available, or end of file
+        if (scan.state == INVALID_STATE || !refill())
             break;
 
-        lexeme.pop_back();
+        input = window();
+    }
+
+    return munch(input, scan);
+}
+
+// NOTE: a refill keeps the lexeme being scanned at the
+// start of the window, so a scan carries on where it
+// stopped
+
+void Lexer::runDfsa(std::string_view input, Scan& scan)
+    const {
+    while (scan.length < input.length()) {
+        scan.state = mDfsa.getTransition(
+            scan.state,
+            input[scan.length]
+        );
+
+        if (scan.state == INVALID_STATE)
+            return;
+
+        scan.length++;
+
+        if (mSpanScanners[scan.state].has_value()) {
+            scan.length += mSpanScanners[scan.state]->span(
+                input.data() + scan.length,
+                input.length() - scan.length
+            );
+        }
+
+        if (mDfsa.isFinalState(scan.state)) {
+            scan.lastFinalState = scan.state;
+            scan.lastFinalLength = scan.length;
+        }
     }
+}
 
-    lexeme = mSource.substr(mCursor, lCursor + 1);
+std::pair<int, std::string_view> Lexer::munch(
+    std::string_view input,
+    Scan const& scan
+) {
+    if (scan.lastFinalState != INVALID_STATE) {
+        return {
+            scan.lastFinalState,
+            input.substr(0, scan.lastFinalLength)
+        };
+    }
 
-    return {INVALID_STATE, lexeme};
+    // the lexeme reported on error includes the character
+    // which could not be consumed
+    return {
+        INVALID_STATE,
+        input.substr(0, scan.length + 1)
+    };
 }
 
 }  // namespace PArL
@@ -1,78 +1,208 @@
 #pragma once
 
+// fmt
+#include <fmt/core.h>
+
 // std
 #include <cstddef>
-#include <functional>
+#include <deque>
+#include <istream>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 // parl
 #include <lexer/Dfsa.hpp>
+#include <lexer/SpanScanner.hpp>
+#include <parl/Interner.hpp>
+#include <parl/LineMap.hpp>
 #include <parl/Token.hpp>
+#include <parl/Value.hpp>
+
+// definitions
+#define STREAM_CHUNK_SIZE (64 * 1024)
+#define MIN_PARALLEL_CHUNK_SIZE (256 * 1024)
 
 namespace PArL {
 
 class Lexer {
    public:
+    // NOTE: trivia are whitespace and comments. When they
+    // are skipped they are consumed by the scanner and
+    // never materialised as tokens.
+    enum class Mode {
+        PRESERVE_TRIVIA,
+        SKIP_TRIVIA,
+    };
+
+    // both are indexed by state and only read for final
+    // states, a state given a literal makes tokens which
+    // carry it and are not decoded again
     Lexer(
         Dfsa dfsa,
-        std::unordered_map<int, std::function<bool(char)>>
-            categoryToChecker,
-        std::unordered_map<int, Token::Type>
-            finalStateToTokenType
+        std::vector<Token::Type> tokenTypes,
+        std::vector<std::optional<Value>> tokenValues = {}
     );
 
     void reset();
 
-    void addSource(std::string const& source);
+    // NOTE: the source is viewed, not copied, so it has to
+    // outlive the tokens lexed from it
+    void addSource(std::string_view source);
+    void addStream(std::istream& stream);
+
+    // tokens before the given position are no longer in
+    // use, so the windows they view into may be freed
+    void release(core::Position position);
+
+    void setMode(Mode mode);
+
+    // identifiers are interned as they are lexed, without an
+    // interner their tokens carry no atom
+    void setInterner(core::Interner* interner);
+
+    // deferred errors are kept instead of printed, to be
+    // taken after the token they were found at
+    void setDeferErrors(bool defer);
+    std::optional<std::string> takeError();
 
     std::optional<Token> nextToken();
 
+    // NOTE: the rest of the source is split into chunks at
+    // line boundaries and each chunk is lexed on a thread
+    // of its own, as if a lexeme started where it does.
+    // When a lexeme runs past the end of a chunk, e.g. a
+    // block comment, the next chunk is lexed again from
+    // where that lexeme ends until both meet at a lexeme
+    // they start, as from there on they agree. The tokens,
+    // up to and including the end of file, and the errors
+    // are those nextToken would give. Streams are not
+    // supported.
+    std::vector<Token> lexParallel(size_t noOfThreads);
+
     [[nodiscard]] Dfsa const& getDfsa() const;
 
+    [[nodiscard]] core::LineMap const& getLineMap() const;
+
     bool hasError() const;
 
    private:
+    // where the automaton stopped, and the longest lexeme
+    // it accepted on the way
+    struct Scan {
+        int state;
+        size_t length{0};
+        int lastFinalState{INVALID_STATE};
+        size_t lastFinalLength{0};
+    };
+
+    // a lexeme which was either turned into a token or
+    // reported with an error
+    struct Lexeme {
+        size_t offset;
+        std::optional<Token> token{};
+        std::optional<std::string> error{};
+    };
+
+    struct Chunk {
+        std::vector<Lexeme> lexemes{};
+        size_t end{0};
+    };
+
+    void initSpanScanners();
+
+    template <typename... T>
+    [[nodiscard]] std::string formatError(
+        core::Position position,
+        fmt::format_string<T...> fmt,
+        T&&... args
+    ) const {
+        return fmt::format(
+            "lexical error at {}:{}:: {}",
+            mLineMap.row(position),
+            mLineMap.col(position),
+            fmt::format(fmt, args...)
+        );
+    }
+
+    void report(std::string message);
+
+    [[nodiscard]] Lexeme createLexeme(
+        size_t offset,
+        std::string_view lexeme,
+        int state
+    ) const;
     [[nodiscard]] Token createToken(
-        std::string const& lexeme,
-        Token::Type type
+        core::Position position,
+        std::string_view lexeme,
+        int state
     ) const;
+    [[nodiscard]] Token intern(Token const& token);
 
-    bool isAtEnd(size_t offset) const;
-    void updateLocationState(std::string const& lexeme);
-
-    [[nodiscard]] std::optional<char> nextCharacter(
-        size_t cursor
-    ) const;
-    [[nodiscard]] std::vector<int> categoriesOf(
-        char character
+    // these only read the lexer, so chunks may be lexed at
+    // the same time
+    [[nodiscard]] std::optional<Lexeme> lexAt(size_t& offset
     ) const;
-    [[nodiscard]] std::pair<int, std::string> simulateDFSA(
-    );
+    [[nodiscard]] Chunk lexChunk(size_t begin, size_t end)
+        const;
+
+    [[nodiscard]] bool isTrivia(int state) const;
+
+    bool isAtEnd();
+    bool refill();
+
+    [[nodiscard]] std::string_view window() const;
+    [[nodiscard]] core::Position currentPosition() const;
+
+    [[nodiscard]] std::pair<int, std::string_view>
+    simulateDFSA();
+
+    void runDfsa(std::string_view input, Scan& scan) const;
+    [[nodiscard]] static std::pair<int, std::string_view>
+    munch(std::string_view input, Scan const& scan);
 
     // source info
     size_t mCursor = 0;
 
-    int mLine = 1;
-    int mColumn = 1;
+    // the window views the source starting from the offset
+    // mWindowBase, unless streaming it is the whole source.
+    // When streaming the window is backed by mWindowBuffer
+    std::string_view mWindow{};
+    std::vector<char> mWindowBuffer{};
+    size_t mWindowBase = 0;
+
+    std::istream* mStream = nullptr;
+    std::deque<std::pair<size_t, std::vector<char>>>
+        mRetiredWindows{};
+
+    core::LineMap mLineMap{};
 
-    std::string mSource{};
+    core::Interner* mInterner = nullptr;
 
     // error info
     bool mHasError = false;
+    bool mDeferErrors = false;
+    std::optional<std::string> mDeferredError{};
 
     // dfsa
     const Dfsa mDfsa;
 
-    // category checkers
-    const std::unordered_map<int, std::function<bool(char)>>
-        mCategoryToChecker;
+    // final state to token type and literal association,
+    // indexed by state
+    std::vector<Token::Type> mTokenTypes{};
+    std::vector<std::optional<Value>> mTokenValues{};
+
+    // final states which produce trivia
+    std::vector<bool> mTriviaStates{};
+
+    // scanners for the states of trivia which loop on
+    // themselves, these skip whole runs of whitespace and
+    // comment bodies at once
+    std::vector<std::optional<SpanScanner>> mSpanScanners{};
 
-    // final state to token type association
-    const std::unordered_map<int, Token::Type>
-        mFinalStateToTokenType;
+    Mode mMode{Mode::PRESERVE_TRIVIA};
 };
 
 }  // namespace PArL
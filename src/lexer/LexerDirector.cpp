@@ -1,8 +1,21 @@
+// std
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
 // parl
 #include <lexer/LexerDirector.hpp>
+#include <lexer/StaticDfsa.hpp>
+
+// definitions
+#define INITIAL_STATE (0)
 
 namespace PArL {
 
+namespace {
+
 enum Category {
     LETTER,
     DIGIT,
@@ -29,288 +42,286 @@ enum Category {
     COMMA,
     COLON,
     SEMICOLON,
+    NO_OF_CATEGORIES,
 };
 
-Lexer LexerDirector::buildLexer() {
-    LexerBuilder builder{};
-
-    builder
-        .addCategory(
-            LETTER,
-            [](char c) -> bool {
-                return ('A' <= c && c <= 'Z') ||
-                       ('a' <= c && c <= 'z');
-            }
-        )
-        .addCategory(
-            DIGIT,
-            [](char c) -> bool {
-                return '0' <= c && c <= '9';
-            }
-        )
-        .addCategory(
-            HEX,
-            [](char c) -> bool {
-                return ('0' <= c && c <= '9') ||
-                       ('A' <= c && c <= 'F') ||
-                       ('a' <= c && c <= 'f');
-            }
-        )
-        .addCategory(
-            SPACE,
-            [](char c) -> bool {
-                return isspace(c) && c != '\n';
-            }
-        )
-        .addCategory(
-            LINEFEED,
-            [](char c) -> bool {
-                return c == '\n';
-            }
-        )
-        .addCategory(
-            DOT,
-            [](char c) -> bool {
-                return c == '.';
-            }
-        )
-        .addCategory(
-            HASH,
-            [](char c) -> bool {
-                return c == '#';
-            }
-        )
-        .addCategory(
-            UNDERSCORE,
-            [](char c) -> bool {
-                return c == '_';
-            }
-        )
-        .addCategory(
-            LEFT_PAREN,
-            [](char c) -> bool {
-                return c == '(';
-            }
-        )
-        .addCategory(
-            RIGHT_PAREN,
-            [](char c) -> bool {
-                return c == ')';
-            }
-        )
-        .addCategory(
-            LEFT_BRACKET,
-            [](char c) -> bool {
-                return c == '[';
-            }
-        )
-        .addCategory(
-            RIGHT_BRACKET,
-            [](char c) -> bool {
-                return c == ']';
-            }
-        )
-        .addCategory(
-            LEFT_BRACE,
-            [](char c) -> bool {
-                return c == '{';
-            }
-        )
-        .addCategory(
-            RIGHT_BRACE,
-            [](char c) -> bool {
-                return c == '}';
-            }
-        )
-        .addCategory(
-            COMMA,
-            [](char c) -> bool {
-                return c == ',';
-            }
-        )
-        .addCategory(
-            RIGHT_PAREN,
-            [](char c) -> bool {
-                return c == ')';
-            }
-        )
-        .addCategory(
-            SEMICOLON,
-            [](char c) -> bool {
-                return c == ';';
-            }
-        )
-        .addCategory(
-            STAR,
-            [](char c) -> bool {
-                return c == '*';
-            }
-        )
-        .addCategory(
-            SLASH,
-            [](char c) -> bool {
-                return c == '/';
-            }
-        )
-        .addCategory(
-            PLUS,
-            [](char c) -> bool {
-                return c == '+';
-            }
-        )
-        .addCategory(
-            MINUS,
-            [](char c) -> bool {
-                return c == '-';
-            }
-        )
-        .addCategory(
-            LESS,
-            [](char c) -> bool {
-                return c == '<';
-            }
-        )
-        .addCategory(
-            GREATER,
-            [](char c) -> bool {
-                return c == '>';
-            }
-        )
-        .addCategory(
-            EQUAL,
-            [](char c) -> bool {
-                return c == '=';
-            }
-        )
-        .addCategory(
-            BANG,
-            [](char c) -> bool {
-                return c == '!';
-            }
-        )
-        .addCategory(
-            COMMA,
-            [](char c) -> bool {
-                return c == ',';
-            }
-        )
-        .addCategory(
-            COLON,
-            [](char c) -> bool {
-                return c == ':';
-            }
-        )
-        .addCategory(SEMICOLON, [](char c) -> bool {
+constexpr bool isInCategory(int category, unsigned char c) {
+    switch (category) {
+        case LETTER:
+            return ('A' <= c && c <= 'Z') ||
+                   ('a' <= c && c <= 'z');
+        case DIGIT:
+            return '0' <= c && c <= '9';
+        case HEX:
+            return ('0' <= c && c <= '9') ||
+                   ('A' <= c && c <= 'F') ||
+                   ('a' <= c && c <= 'f');
+        case SPACE:
+            // isspace in the "C" locale, less the linefeed
+            return c == ' ' || c == '\t' || c == '\v' ||
+                   c == '\f' || c == '\r';
+        case LINEFEED:
+            return c == '\n';
+        case DOT:
+            return c == '.';
+        case HASH:
+            return c == '#';
+        case UNDERSCORE:
+            return c == '_';
+        case LEFT_PAREN:
+            return c == '(';
+        case RIGHT_PAREN:
+            return c == ')';
+        case LEFT_BRACKET:
+            return c == '[';
+        case RIGHT_BRACKET:
+            return c == ']';
+        case LEFT_BRACE:
+            return c == '{';
+        case RIGHT_BRACE:
+            return c == '}';
+        case STAR:
+            return c == '*';
+        case SLASH:
+            return c == '/';
+        case PLUS:
+            return c == '+';
+        case MINUS:
+            return c == '-';
+        case LESS:
+            return c == '<';
+        case GREATER:
+            return c == '>';
+        case EQUAL:
+            return c == '=';
+        case BANG:
+            return c == '!';
+        case COMMA:
+            return c == ',';
+        case COLON:
+            return c == ':';
+        case SEMICOLON:
             return c == ';';
-        });
+        default:
+            return false;
+    }
+}
 
+constexpr StaticTransition TRANSITIONS[] = {
     // whitespace
-    builder.addTransition(0, {SPACE, LINEFEED}, 1)
-        .addTransition(1, {SPACE, LINEFEED}, 1)
-        .setStateAsFinal(1, Token::Type::WHITESPACE);
+    {0, categories({SPACE, LINEFEED}), 1},
+    {1, categories({SPACE, LINEFEED}), 1},
 
     // identifier
-    builder.addTransition(0, {LETTER, UNDERSCORE}, 2)
-        .addTransition(2, {LETTER, DIGIT, UNDERSCORE}, 2)
-        .setStateAsFinal(2, Token::Type::IDENTIFIER);
+    {0, categories({LETTER, UNDERSCORE}), 2},
+    {2, categories({LETTER, DIGIT, UNDERSCORE}), 2},
 
     // integers & floats
-    builder.addTransition(0, DIGIT, 3)
-        .addTransition(3, DIGIT, 3)
-        .setStateAsFinal(3, Token::Type::INTEGER)
-        .addTransition(3, DOT, 4)
-        .addTransition(4, DIGIT, 5)
-        .addTransition(5, DIGIT, 5)
-        .setStateAsFinal(5, Token::Type::FLOAT);
+    {0, categories({DIGIT}), 3},
+    {3, categories({DIGIT}), 3},
+    {3, categories({DOT}), 4},
+    {4, categories({DIGIT}), 5},
+    {5, categories({DIGIT}), 5},
 
     // color
-    builder.addTransition(0, HASH, 6)
-        .addTransition(6, HEX, 7)
-        .addTransition(7, HEX, 8)
-        .addTransition(8, HEX, 9)
-        .addTransition(9, HEX, 10)
-        .addTransition(10, HEX, 11)
-        .addTransition(11, HEX, 12)
-        .setStateAsFinal(12, Token::Type::COLOR);
+    {0, categories({HASH}), 6},
+    {6, categories({HEX}), 7},
+    {7, categories({HEX}), 8},
+    {8, categories({HEX}), 9},
+    {9, categories({HEX}), 10},
+    {10, categories({HEX}), 11},
+    {11, categories({HEX}), 12},
 
     // punctuation "(", ")", "{", "}", ";", ",", ":", "[",
-    // "]",
-    // "*", "+"
-    builder.addTransition(0, LEFT_PAREN, 13)
-        .addTransition(0, RIGHT_PAREN, 14)
-        .addTransition(0, LEFT_BRACE, 15)
-        .addTransition(0, RIGHT_BRACE, 16)
-        .addTransition(0, SEMICOLON, 17)
-        .addTransition(0, COMMA, 18)
-        .addTransition(0, COLON, 19)
-        .addTransition(0, LEFT_BRACKET, 20)
-        .addTransition(0, RIGHT_BRACKET, 21)
-        .addTransition(0, STAR, 22)
-        .addTransition(0, PLUS, 23)
-        .setStateAsFinal(13, Token::Type::LEFT_PAREN)
-        .setStateAsFinal(14, Token::Type::RIGHT_PAREN)
-        .setStateAsFinal(15, Token::Type::LEFT_BRACE)
-        .setStateAsFinal(16, Token::Type::RIGHT_BRACE)
-        .setStateAsFinal(17, Token::Type::SEMICOLON)
-        .setStateAsFinal(18, Token::Type::COMMA)
-        .setStateAsFinal(19, Token::Type::COLON)
-        .setStateAsFinal(20, Token::Type::LEFT_BRACK)
-        .setStateAsFinal(21, Token::Type::RIGHT_BRACK)
-        .setStateAsFinal(22, Token::Type::STAR)
-        .setStateAsFinal(23, Token::Type::PLUS);
+    // "]", "*", "+"
+    {0, categories({LEFT_PAREN}), 13},
+    {0, categories({RIGHT_PAREN}), 14},
+    {0, categories({LEFT_BRACE}), 15},
+    {0, categories({RIGHT_BRACE}), 16},
+    {0, categories({SEMICOLON}), 17},
+    {0, categories({COMMA}), 18},
+    {0, categories({COLON}), 19},
+    {0, categories({LEFT_BRACKET}), 20},
+    {0, categories({RIGHT_BRACKET}), 21},
+    {0, categories({STAR}), 22},
+    {0, categories({PLUS}), 23},
 
     // "=", "=="
-    builder.addTransition(0, EQUAL, 24)
-        .setStateAsFinal(24, Token::Type::EQUAL)
-        .addTransition(24, EQUAL, 25)
-        .setStateAsFinal(25, Token::Type::EQUAL_EQUAL);
+    {0, categories({EQUAL}), 24},
+    {24, categories({EQUAL}), 25},
 
     // "<", "<="
-    builder.addTransition(0, LESS, 26)
-        .setStateAsFinal(26, Token::Type::LESS)
-        .addTransition(26, EQUAL, 27)
-        .setStateAsFinal(27, Token::Type::LESS_EQUAL);
+    {0, categories({LESS}), 26},
+    {26, categories({EQUAL}), 27},
 
     // ">", ">="
-    builder.addTransition(0, GREATER, 28)
-        .setStateAsFinal(28, Token::Type::GREATER)
-        .addTransition(28, EQUAL, 29)
-        .setStateAsFinal(29, Token::Type::GREATER_EQUAL);
+    {0, categories({GREATER}), 28},
+    {28, categories({EQUAL}), 29},
 
     // "-", "->"
-    builder.addTransition(0, MINUS, 30)
-        .setStateAsFinal(30, Token::Type::MINUS)
-        .addTransition(30, GREATER, 31)
-        .setStateAsFinal(31, Token::Type::ARROW);
+    {0, categories({MINUS}), 30},
+    {30, categories({GREATER}), 31},
 
-    // !="
-    builder.addTransition(0, BANG, 32)
-        .addTransition(32, EQUAL, 33)
-        .setStateAsFinal(33, Token::Type::BANG_EQUAL);
+    // "!="
+    {0, categories({BANG}), 32},
+    {32, categories({EQUAL}), 33},
 
     // "/", "//", "/* ... */"
-    builder.addTransition(0, SLASH, 34)
-        .setStateAsFinal(34, Token::Type::SLASH)
-        .addTransition(34, SLASH, 35)
-        .addComplementaryTransition(35, LINEFEED, 35)
-        .setStateAsFinal(35, Token::Type::COMMENT)
-        .addTransition(34, STAR, 36)
-        .addComplementaryTransition(36, STAR, 36)
-        .addTransition(36, STAR, 37)
-        .addComplementaryTransition(37, SLASH, 36)
-        .addTransition(37, SLASH, 38)
-        .setStateAsFinal(38, Token::Type::COMMENT);
+    {0, categories({SLASH}), 34},
+    {34, categories({SLASH}), 35},
+    {35, categories({LINEFEED}), 35, true},
+    {34, categories({STAR}), 36},
+    {36, categories({STAR}), 36, true},
+    {36, categories({STAR}), 37},
+    {37, categories({SLASH}), 36, true},
+    {37, categories({SLASH}), 38},
 
     // builtin
-    builder.addTransition(0, UNDERSCORE, 39)
-        .addTransition(39, UNDERSCORE, 40)
-        .addTransition(40, LETTER, 41)
-        .addTransition(41, {LETTER, DIGIT, UNDERSCORE}, 41)
-        .setStateAsFinal(41, Token::Type::BUILTIN);
+    {0, categories({UNDERSCORE}), 39},
+    {39, categories({UNDERSCORE}), 40},
+    {40, categories({LETTER}), 41},
+    {41, categories({LETTER, DIGIT, UNDERSCORE}), 41},
+};
+
+constexpr StaticFinalState FINAL_STATES[] = {
+    {1, Token::Type::WHITESPACE},
+    {2, Token::Type::IDENTIFIER},
+    {3, Token::Type::INTEGER},
+    {5, Token::Type::FLOAT},
+    {12, Token::Type::COLOR},
+    {13, Token::Type::LEFT_PAREN},
+    {14, Token::Type::RIGHT_PAREN},
+    {15, Token::Type::LEFT_BRACE},
+    {16, Token::Type::RIGHT_BRACE},
+    {17, Token::Type::SEMICOLON},
+    {18, Token::Type::COMMA},
+    {19, Token::Type::COLON},
+    {20, Token::Type::LEFT_BRACK},
+    {21, Token::Type::RIGHT_BRACK},
+    {22, Token::Type::STAR},
+    {23, Token::Type::PLUS},
+    {24, Token::Type::EQUAL},
+    {25, Token::Type::EQUAL_EQUAL},
+    {26, Token::Type::LESS},
+    {27, Token::Type::LESS_EQUAL},
+    {28, Token::Type::GREATER},
+    {29, Token::Type::GREATER_EQUAL},
+    {30, Token::Type::MINUS},
+    {31, Token::Type::ARROW},
+    {33, Token::Type::BANG_EQUAL},
+    {34, Token::Type::SLASH},
+    {35, Token::Type::COMMENT},
+    {38, Token::Type::COMMENT},
+    {41, Token::Type::BUILTIN},
+};
+
+constexpr StaticKeyword KEYWORDS[] = {
+    // types
+    {"float", Token::Type::FLOAT_TYPE},
+    {"int", Token::Type::INTEGER_TYPE},
+    {"bool", Token::Type::BOOL_TYPE},
+    {"color", Token::Type::COLOR_TYPE},
+
+    // keywords
+    {"and", Token::Type::AND},
+    {"or", Token::Type::OR},
+    {"not", Token::Type::NOT},
+    {"as", Token::Type::AS},
+    {"let", Token::Type::LET},
+    {"return", Token::Type::RETURN},
+    {"if", Token::Type::IF},
+    {"else", Token::Type::ELSE},
+    {"for", Token::Type::FOR},
+    {"while", Token::Type::WHILE},
+    {"fun", Token::Type::FUN},
+
+    // literals
+    {"true", Token::Type::BOOL, Value{true}},
+    {"false", Token::Type::BOOL, Value{false}},
+
+    // builtins, any other name of the same form is lexed as
+    // a builtin which is then reported as undefined
+    {"__width", Token::Type::BUILTIN, Value{core::Builtin::WIDTH}},
+    {"__height",
+     Token::Type::BUILTIN,
+     Value{core::Builtin::HEIGHT}},
+    {"__read", Token::Type::BUILTIN, Value{core::Builtin::READ}},
+    {"__random_int",
+     Token::Type::BUILTIN,
+     Value{core::Builtin::RANDOM_INT}},
+    {"__print", Token::Type::BUILTIN, Value{core::Builtin::PRINT}},
+    {"__delay", Token::Type::BUILTIN, Value{core::Builtin::DELAY}},
+    {"__write", Token::Type::BUILTIN, Value{core::Builtin::WRITE}},
+    {"__write_box",
+     Token::Type::BUILTIN,
+     Value{core::Builtin::WRITE_BOX}},
+    {"__clear", Token::Type::BUILTIN, Value{core::Builtin::CLEAR}},
+};
+
+constexpr size_t NO_OF_STATES =
+    countStates(TRANSITIONS) + countKeywordStates(KEYWORDS);
+
+// resolved, minimised and compressed by the compiler, only
+// the last of these ends up in the program
+constexpr auto COMPILED_DFSA =
+    compileDfsa<NO_OF_STATES, NO_OF_CATEGORIES>(
+        isInCategory,
+        TRANSITIONS,
+        FINAL_STATES,
+        KEYWORDS,
+        INITIAL_STATE
+    );
+
+constexpr auto REDUCED_DFSA = reduceDfsa(COMPILED_DFSA);
+
+constexpr auto DFSA = shrinkDfsa<
+    REDUCED_DFSA.noOfStates,
+    REDUCED_DFSA.noOfClasses>(REDUCED_DFSA);
+
+// the literal each state's tokens carry, if any
+constexpr auto TOKEN_VALUES = [] {
+    std::array<std::optional<Value>, DFSA.noOfStates>
+        values{};
+
+    for (size_t state = 0; state < DFSA.noOfStates; state++) {
+        int16_t keyword = DFSA.keywords[state];
 
-    builder.setInitialState(0);
+        if (keyword != -1)
+            values[state] = KEYWORDS[keyword].value;
+    }
 
-    return builder.build();
+    return values;
+}();
+
+}  // namespace
+
+Lexer LexerDirector::buildLexer() {
+    Dfsa dfsa(
+        DFSA.noOfStates,
+        DFSA.noOfClasses,
+        DFSA.byteClasses,
+        std::vector<int16_t>(
+            DFSA.transitionTable.begin(),
+            DFSA.transitionTable.end()
+        ),
+        DFSA.initialState,
+        std::vector<bool>(
+            DFSA.finalStates.begin(),
+            DFSA.finalStates.end()
+        )
+    );
+
+    return Lexer(
+        std::move(dfsa),
+        std::vector<Token::Type>(
+            DFSA.tokenTypes.begin(),
+            DFSA.tokenTypes.end()
+        ),
+        std::vector<std::optional<Value>>(
+            TOKEN_VALUES.begin(),
+            TOKEN_VALUES.end()
+        )
+    );
 }
 
 }  // namespace PArL
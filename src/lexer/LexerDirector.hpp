@@ -1,7 +1,7 @@
 #pragma once
 
 // parl
-#include <lexer/LexerBuilder.hpp>
+#include <lexer/Lexer.hpp>
 #include <parl/Token.hpp>
 
 namespace PArL {
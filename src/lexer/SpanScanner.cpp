@@ -0,0 +1,189 @@
+// parl
+#include <lexer/SpanScanner.hpp>
+
+// simd
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// NOTE: the build does not target AVX2, so its path is
+// compiled for it on its own and only taken when the
+// processor running the lexer supports it
+#if defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define HAS_AVX2_PATH
+#endif
+
+namespace PArL {
+
+#if defined(HAS_AVX2_PATH)
+namespace {
+
+bool hasAvx2() {
+    static bool const supported = [] {
+        __builtin_cpu_init();
+
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+
+    return supported;
+}
+
+}  // namespace
+#endif
+
+std::optional<SpanScanner> SpanScanner::fromSet(
+    std::bitset<256> const& set
+) {
+    SpanScanner scanner{};
+
+    scanner.mSet = set;
+
+    int byte = 0;
+
+    while (byte < 256) {
+        if (set[byte]) {
+            byte++;
+
+            continue;
+        }
+
+        int low = byte;
+
+        while (byte < 256 && !set[byte]) {
+            byte++;
+        }
+
+        if (scanner.mNoOfStopRanges >= MAX_STOP_RANGES)
+            return {};
+
+        scanner.mStopLow[scanner.mNoOfStopRanges] =
+            static_cast<uint8_t>(low);
+        scanner.mStopWidth[scanner.mNoOfStopRanges] =
+            static_cast<uint8_t>(byte - 1 - low);
+
+        scanner.mNoOfStopRanges++;
+    }
+
+    return scanner;
+}
+
+// NOTE: a byte x lies in the inclusive range [low, low + width]
+// exactly when the wrapping difference x - low does not
+// exceed width. Using a saturating subtraction this becomes
+// (x - low) -sat width == 0, which needs only SSE2.
+
+size_t SpanScanner::span(char const* data, size_t length)
+    const {
+    size_t offset = 0;
+
+#if defined(HAS_AVX2_PATH)
+    if (hasAvx2()) {
+        offset = spanAvx2(data, length);
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i zero128 = _mm_setzero_si128();
+
+    while (offset + 16 <= length) {
+        __m128i chunk = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(data + offset)
+        );
+
+        __m128i stop = zero128;
+
+        for (size_t i = 0; i < mNoOfStopRanges; i++) {
+            __m128i shifted = _mm_sub_epi8(
+                chunk,
+                _mm_set1_epi8(static_cast<char>(mStopLow[i]))
+            );
+            __m128i excess = _mm_subs_epu8(
+                shifted,
+                _mm_set1_epi8(static_cast<char>(mStopWidth[i]))
+            );
+
+            stop = _mm_or_si128(
+                stop,
+                _mm_cmpeq_epi8(excess, zero128)
+            );
+        }
+
+        auto mask =
+            static_cast<uint32_t>(_mm_movemask_epi8(stop));
+
+        if (mask != 0)
+            return offset + __builtin_ctz(mask);
+
+        offset += 16;
+    }
+#endif
+
+    return offset +
+           spanScalar(data + offset, length - offset);
+}
+
+#if defined(HAS_AVX2_PATH)
+// stops at the first byte not in the set, or where fewer
+// than 32 bytes are left, span carries on from there
+__attribute__((target("avx2")))
+size_t SpanScanner::spanAvx2(
+    char const* data,
+    size_t length
+) const {
+    size_t offset = 0;
+    const __m256i zero = _mm256_setzero_si256();
+
+    while (offset + 32 <= length) {
+        __m256i chunk = _mm256_loadu_si256(
+            reinterpret_cast<__m256i const*>(data + offset)
+        );
+
+        __m256i stop = zero;
+
+        for (size_t i = 0; i < mNoOfStopRanges; i++) {
+            __m256i shifted = _mm256_sub_epi8(
+                chunk,
+                _mm256_set1_epi8(static_cast<char>(mStopLow[i]))
+            );
+            __m256i excess = _mm256_subs_epu8(
+                shifted,
+                _mm256_set1_epi8(
+                    static_cast<char>(mStopWidth[i])
+                )
+            );
+
+            stop = _mm256_or_si256(
+                stop,
+                _mm256_cmpeq_epi8(excess, zero)
+            );
+        }
+
+        auto mask =
+            static_cast<uint32_t>(_mm256_movemask_epi8(stop));
+
+        if (mask != 0)
+            return offset + __builtin_ctz(mask);
+
+        offset += 32;
+    }
+
+    return offset;
+}
+#endif
+
+size_t SpanScanner::spanScalar(
+    char const* data,
+    size_t length
+) const {
+    size_t offset = 0;
+
+    while (offset < length &&
+           mSet[static_cast<unsigned char>(data[offset])]) {
+        offset++;
+    }
+
+    return offset;
+}
+
+}  // namespace PArL
@@ -0,0 +1,55 @@
+#pragma once
+
+// std
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// macro definitions
+#define MAX_STOP_RANGES (16)
+
+namespace PArL {
+
+// NOTE: a span scanner finds the length of the longest prefix
+// of a buffer whose bytes all belong to a given set, much
+// like strspn. The complement of the set is kept as a small
+// number of byte ranges so that the search can be done 16
+// (SSE2) or 32 (AVX2, when the processor has it) bytes at a
+// time. When neither is available, or for the tail of the
+// buffer, a plain table lookup is used instead.
+
+class SpanScanner {
+   public:
+    [[nodiscard]] static std::optional<SpanScanner> fromSet(
+        std::bitset<256> const& set
+    );
+
+    [[nodiscard]] size_t span(
+        char const* data,
+        size_t length
+    ) const;
+
+   private:
+    SpanScanner() = default;
+
+    [[nodiscard]] size_t spanAvx2(
+        char const* data,
+        size_t length
+    ) const;
+    [[nodiscard]] size_t spanScalar(
+        char const* data,
+        size_t length
+    ) const;
+
+    // bytes in the set
+    std::bitset<256> mSet{};
+
+    // bytes not in the set as inclusive ranges
+    size_t mNoOfStopRanges{0};
+    std::array<uint8_t, MAX_STOP_RANGES> mStopLow{};
+    std::array<uint8_t, MAX_STOP_RANGES> mStopWidth{};
+};
+
+}  // namespace PArL
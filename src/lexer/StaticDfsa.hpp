@@ -0,0 +1,400 @@
+#pragma once
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+
+// parl
+#include <lexer/Dfsa.hpp>
+#include <lexer/Minimisation.hpp>
+#include <parl/Token.hpp>
+#include <parl/Value.hpp>
+
+namespace PArL {
+
+// NOTE: a lexer specification given as constexpr data.
+// Categories are sets of bytes and transitions are given per
+// category, and the table is resolved by the compiler so no
+// work is left for when the program starts. Transitions
+// listed later take precedence over earlier ones on the
+// same category, and a byte in more than one category
+// follows the lowest numbered category which has a
+// transition.
+//
+// Keywords are recognised by the automaton itself, each is
+// given a path of states of its own which otherwise behave
+// like the states the specification would have reached, so
+// the lexer never has to look a lexeme up.
+
+using CategorySet = uint32_t;
+
+struct StaticTransition {
+    int state;
+    CategorySet categories;
+    int nextState;
+    // the transition applies to every category except the
+    // ones given
+    bool complementary = false;
+};
+
+struct StaticFinalState {
+    int state;
+    Token::Type type;
+};
+
+struct StaticKeyword {
+    std::string_view lexeme;
+    Token::Type type;
+    // the literal carried by the token, if any
+    std::optional<Value> value{};
+};
+
+// the table has a row per state and a column per byte
+// class, the capacities are upper bounds on both
+template <size_t MaxStates, size_t MaxClasses>
+struct StaticDfsa {
+    size_t noOfStates{0};
+    size_t noOfClasses{0};
+    int initialState{0};
+    std::array<uint8_t, NO_OF_BYTES> byteClasses{};
+    std::array<int16_t, MaxStates * MaxClasses>
+        transitionTable{};
+    std::array<bool, MaxStates> finalStates{};
+    std::array<Token::Type, MaxStates> tokenTypes{};
+    // the keyword accepted by each state, or -1
+    std::array<int16_t, MaxStates> keywords{};
+};
+
+constexpr CategorySet categories(
+    std::initializer_list<int> members
+) {
+    CategorySet set = 0;
+
+    for (int category : members)
+        set |= CategorySet{1} << category;
+
+    return set;
+}
+
+template <size_t NoOfTransitions>
+constexpr size_t countStates(
+    StaticTransition const (&transitions)[NoOfTransitions]
+) {
+    size_t noOfStates = 0;
+
+    for (auto const& transition : transitions) {
+        auto state = static_cast<size_t>(transition.state);
+        auto nextState =
+            static_cast<size_t>(transition.nextState);
+
+        if (state >= noOfStates)
+            noOfStates = state + 1;
+
+        if (nextState >= noOfStates)
+            noOfStates = nextState + 1;
+    }
+
+    return noOfStates;
+}
+
+// one state per distinct prefix of the keywords
+template <size_t NoOfKeywords>
+constexpr size_t countKeywordStates(
+    StaticKeyword const (&keywords)[NoOfKeywords]
+) {
+    size_t noOfStates = 0;
+
+    for (size_t i = 0; i < NoOfKeywords; i++) {
+        std::string_view lexeme = keywords[i].lexeme;
+
+        for (size_t length = 1; length <= lexeme.length();
+             length++) {
+            bool isShared = false;
+
+            for (size_t j = 0; j < i && !isShared; j++) {
+                isShared =
+                    keywords[j].lexeme.substr(0, length) ==
+                    lexeme.substr(0, length);
+            }
+
+            if (!isShared)
+                noOfStates++;
+        }
+    }
+
+    return noOfStates;
+}
+
+template <size_t NoOfKeywords>
+constexpr bool isKeywordByte(
+    StaticKeyword const (&keywords)[NoOfKeywords],
+    unsigned char byte
+) {
+    for (auto const& keyword : keywords) {
+        for (char c : keyword.lexeme) {
+            if (static_cast<unsigned char>(c) == byte)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+// bytes in the same categories start out in the same class,
+// this keeps the work left to the compiler small. Bytes
+// which appear in keywords are given a class each.
+template <
+    size_t NoOfStates,
+    size_t NoOfCategories,
+    size_t NoOfTransitions,
+    size_t NoOfFinalStates,
+    size_t NoOfKeywords>
+constexpr StaticDfsa<NoOfStates, NO_OF_BYTES> compileDfsa(
+    bool (*isInCategory)(int, unsigned char),
+    StaticTransition const (&transitions)[NoOfTransitions],
+    StaticFinalState const (&finalStates)[NoOfFinalStates],
+    StaticKeyword const (&keywords)[NoOfKeywords],
+    int initialState
+) {
+    static_assert(
+        NoOfCategories <= sizeof(CategorySet) * 8,
+        "too many categories for a category set"
+    );
+    static_assert(
+        NoOfStates <= INT16_MAX,
+        "too many states for the transition table"
+    );
+
+    size_t noOfBaseStates = countStates(transitions);
+
+    // next state per (state, category)
+    std::array<int16_t, NoOfStates * NoOfCategories>
+        byCategory{};
+
+    for (size_t i = 0; i < byCategory.size(); i++)
+        byCategory[i] = INVALID_STATE;
+
+    for (auto const& transition : transitions) {
+        for (size_t category = 0; category < NoOfCategories;
+             category++) {
+            bool isMember =
+                (transition.categories >> category) & 1;
+
+            if (isMember != transition.complementary) {
+                byCategory
+                    [transition.state * NoOfCategories +
+                     category] =
+                        static_cast<int16_t>(
+                            transition.nextState
+                        );
+            }
+        }
+    }
+
+    StaticDfsa<NoOfStates, NO_OF_BYTES> dfsa{};
+
+    // the categories of each class, and its byte if it is
+    // one which appears in keywords
+    std::array<CategorySet, NO_OF_BYTES> classCategories{};
+    std::array<int, NO_OF_BYTES> classBytes{};
+
+    for (size_t byte = 0; byte < NO_OF_BYTES; byte++) {
+        CategorySet set = 0;
+
+        for (size_t category = 0; category < NoOfCategories;
+             category++) {
+            if (isInCategory(category, byte))
+                set |= CategorySet{1} << category;
+        }
+
+        int classByte = isKeywordByte(keywords, byte)
+                            ? static_cast<int>(byte)
+                            : -1;
+
+        size_t byteClass = 0;
+
+        while (byteClass < dfsa.noOfClasses &&
+               (classCategories[byteClass] != set ||
+                classBytes[byteClass] != classByte))
+            byteClass++;
+
+        if (byteClass == dfsa.noOfClasses) {
+            classCategories[byteClass] = set;
+            classBytes[byteClass] = classByte;
+            dfsa.noOfClasses++;
+        }
+
+        dfsa.byteClasses[byte] =
+            static_cast<uint8_t>(byteClass);
+    }
+
+    for (size_t state = 0; state < noOfBaseStates; state++) {
+        for (size_t byteClass = 0;
+             byteClass < dfsa.noOfClasses;
+             byteClass++) {
+            int16_t next = INVALID_STATE;
+            CategorySet set = classCategories[byteClass];
+
+            for (size_t category = 0;
+                 set != 0 && next == INVALID_STATE;
+                 category++, set >>= 1) {
+                if (set & 1) {
+                    next = byCategory
+                        [state * NoOfCategories + category];
+                }
+            }
+
+            dfsa.transitionTable
+                [state * dfsa.noOfClasses + byteClass] = next;
+        }
+    }
+
+    for (size_t state = 0; state < NoOfStates; state++)
+        dfsa.keywords[state] = -1;
+
+    for (auto const& finalState : finalStates) {
+        dfsa.finalStates[finalState.state] = true;
+        dfsa.tokenTypes[finalState.state] = finalState.type;
+    }
+
+    dfsa.noOfStates = noOfBaseStates;
+    dfsa.initialState = initialState;
+
+    size_t noOfClasses = dfsa.noOfClasses;
+
+    // thread each keyword through the automaton, a state is
+    // added for every prefix not seen before and starts out
+    // as a copy of the state it replaces
+    for (size_t keyword = 0; keyword < NoOfKeywords;
+         keyword++) {
+        size_t state = initialState;
+
+        for (char c : keywords[keyword].lexeme) {
+            size_t byteClass = dfsa.byteClasses
+                [static_cast<unsigned char>(c)];
+            int16_t next = dfsa.transitionTable
+                [state * noOfClasses + byteClass];
+
+            if (next >= static_cast<int16_t>(noOfBaseStates)) {
+                state = next;
+
+                continue;
+            }
+
+            size_t added = dfsa.noOfStates++;
+
+            for (size_t other = 0; other < noOfClasses;
+                 other++) {
+                dfsa.transitionTable
+                    [added * noOfClasses + other] =
+                    next == INVALID_STATE
+                        ? INVALID_STATE
+                        : dfsa.transitionTable
+                              [next * noOfClasses + other];
+            }
+
+            if (next != INVALID_STATE) {
+                dfsa.finalStates[added] =
+                    dfsa.finalStates[next];
+                dfsa.tokenTypes[added] = dfsa.tokenTypes[next];
+            }
+
+            dfsa.transitionTable
+                [state * noOfClasses + byteClass] =
+                static_cast<int16_t>(added);
+
+            state = added;
+        }
+
+        dfsa.finalStates[state] = true;
+        dfsa.tokenTypes[state] = keywords[keyword].type;
+        dfsa.keywords[state] = static_cast<int16_t>(keyword);
+    }
+
+    return dfsa;
+}
+
+// minimises the states and merges the byte classes, the
+// capacities are left as they were
+template <size_t MaxStates, size_t MaxClasses>
+constexpr StaticDfsa<MaxStates, MaxClasses> reduceDfsa(
+    StaticDfsa<MaxStates, MaxClasses> const& dfsa
+) {
+    StaticDfsa<MaxStates, MaxClasses> reduced = dfsa;
+
+    std::array<int, MaxStates> labels{};
+    std::array<int16_t, MaxStates> stateMap{};
+    std::array<int, reductionScratchSize(MaxStates, MaxClasses)>
+        scratch{};
+
+    // keyword states may carry different literals, so they
+    // are never merged with anything
+    for (size_t state = 0; state < dfsa.noOfStates; state++) {
+        if (dfsa.keywords[state] != -1)
+            labels[state] = -2 - dfsa.keywords[state];
+        else if (dfsa.finalStates[state])
+            labels[state] = static_cast<int>(dfsa.tokenTypes[state]);
+        else
+            labels[state] = -1;
+    }
+
+    ReducedSize size = reduceDfsa(
+        reduced.transitionTable.data(),
+        dfsa.noOfStates,
+        dfsa.noOfClasses,
+        dfsa.byteClasses.data(),
+        labels.data(),
+        reduced.byteClasses.data(),
+        stateMap.data(),
+        scratch.data()
+    );
+
+    reduced.noOfStates = size.noOfStates;
+    reduced.noOfClasses = size.noOfClasses;
+    reduced.initialState = stateMap[dfsa.initialState];
+
+    for (size_t state = 0; state < dfsa.noOfStates; state++) {
+        reduced.finalStates[stateMap[state]] =
+            dfsa.finalStates[state];
+        reduced.tokenTypes[stateMap[state]] =
+            dfsa.tokenTypes[state];
+        reduced.keywords[stateMap[state]] =
+            dfsa.keywords[state];
+    }
+
+    return reduced;
+}
+
+// copies into a dfsa whose capacities match its size
+template <
+    size_t NoOfStates,
+    size_t NoOfClasses,
+    size_t MaxStates,
+    size_t MaxClasses>
+constexpr StaticDfsa<NoOfStates, NoOfClasses> shrinkDfsa(
+    StaticDfsa<MaxStates, MaxClasses> const& dfsa
+) {
+    StaticDfsa<NoOfStates, NoOfClasses> shrunk{};
+
+    shrunk.noOfStates = NoOfStates;
+    shrunk.noOfClasses = NoOfClasses;
+    shrunk.initialState = dfsa.initialState;
+    shrunk.byteClasses = dfsa.byteClasses;
+
+    for (size_t i = 0; i < NoOfStates * NoOfClasses; i++)
+        shrunk.transitionTable[i] = dfsa.transitionTable[i];
+
+    for (size_t state = 0; state < NoOfStates; state++) {
+        shrunk.finalStates[state] = dfsa.finalStates[state];
+        shrunk.tokenTypes[state] = dfsa.tokenTypes[state];
+        shrunk.keywords[state] = dfsa.keywords[state];
+    }
+
+    return shrunk;
+}
+
+}  // namespace PArL
@@ -0,0 +1,64 @@
+// parl
+#include <lexer/TokenQueue.hpp>
+
+// std
+#include <thread>
+#include <utility>
+
+namespace PArL {
+
+TokenQueue::TokenQueue()
+    : mEntries(TOKEN_QUEUE_CAPACITY) {
+}
+
+// NOTE: the indices only ever grow, an entry is found by
+// wrapping its index around the capacity. The side which
+// writes an index publishes it with release so that the
+// entries it is done with are visible to the other side.
+
+bool TokenQueue::push(Entry entry) {
+    size_t tail = mTail.load(std::memory_order_relaxed);
+
+    while (tail - mHead.load(std::memory_order_acquire) ==
+           TOKEN_QUEUE_CAPACITY) {
+        if (mClosed.load(std::memory_order_acquire))
+            return false;
+
+        std::this_thread::yield();
+    }
+
+    if (mClosed.load(std::memory_order_acquire))
+        return false;
+
+    mEntries[tail % TOKEN_QUEUE_CAPACITY] = std::move(entry);
+
+    mTail.store(tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+TokenQueue::Entry TokenQueue::pop() {
+    size_t head = mHead.load(std::memory_order_relaxed);
+
+    while (mTail.load(std::memory_order_acquire) == head)
+        std::this_thread::yield();
+
+    Entry entry =
+        std::move(mEntries[head % TOKEN_QUEUE_CAPACITY]);
+
+    mHead.store(head + 1, std::memory_order_release);
+
+    return entry;
+}
+
+void TokenQueue::close() {
+    mClosed.store(true, std::memory_order_release);
+}
+
+void TokenQueue::reset() {
+    mHead.store(0, std::memory_order_relaxed);
+    mTail.store(0, std::memory_order_relaxed);
+    mClosed.store(false, std::memory_order_relaxed);
+}
+
+}  // namespace PArL
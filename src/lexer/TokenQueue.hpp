@@ -0,0 +1,61 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+// parl
+#include <parl/Token.hpp>
+
+// definitions
+#define TOKEN_QUEUE_CAPACITY (1024)
+#define CACHE_LINE_SIZE (64)
+
+namespace PArL {
+
+// NOTE: a bounded queue of tokens between exactly one lexer
+// thread and one parser thread. The ends only share the two
+// indices, each written by one side, so no locks are taken.
+// A full queue makes the lexer wait for the parser and an
+// empty one the parser for the lexer. Errors travel through
+// the queue with the tokens so they are reported in the
+// order they would have been without the lexer thread.
+
+class TokenQueue {
+   public:
+    struct Entry {
+        std::optional<Token> token{};
+        std::optional<std::string> error{};
+    };
+
+    TokenQueue();
+
+    // waits while the queue is full, gives up and returns
+    // false if the queue was closed in the meantime
+    bool push(Entry entry);
+
+    // waits while the queue is empty
+    Entry pop();
+
+    // the parser no longer needs tokens, the lexer stops at
+    // its next push
+    void close();
+
+    // neither thread may be using the queue
+    void reset();
+
+   private:
+    std::vector<Entry> mEntries;
+
+    // next entry to pop, written by the parser
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mHead{0};
+    // next entry to push, written by the lexer
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mTail{0};
+
+    alignas(CACHE_LINE_SIZE) std::atomic<bool> mClosed{false};
+};
+
+}  // namespace PArL
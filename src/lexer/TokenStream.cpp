@@ -0,0 +1,90 @@
+// parl
+#include <lexer/TokenStream.hpp>
+#include <parl/Core.hpp>
+
+namespace PArL {
+
+void TokenStream::fill(
+    Lexer& lexer,
+    std::string_view source,
+    size_t noOfThreads
+) {
+    clear();
+
+    mSource = source;
+
+    if (noOfThreads > 1) {
+        std::vector<Token> tokens =
+            lexer.lexParallel(noOfThreads);
+
+        for (Token const& token : tokens)
+            push(token);
+
+        return;
+    }
+
+    for (;;) {
+        std::optional<Token> token = lexer.nextToken();
+
+        // erroneous lexemes are reported by the lexer
+        if (!token.has_value())
+            continue;
+
+        push(*token);
+
+        if (token->getType() == Token::Type::END_OF_FILE)
+            break;
+    }
+}
+
+void TokenStream::push(Token const& token) {
+    mTypes.push_back(token.getType());
+    mOffsets.push_back(token.getPosition().offset());
+    mLengths.push_back(
+        static_cast<uint32_t>(token.getLexeme().length())
+    );
+    mValues.push_back(token.getValue());
+}
+
+void TokenStream::clear() {
+    mSource = {};
+    mTypes.clear();
+    mOffsets.clear();
+    mLengths.clear();
+    mValues.clear();
+}
+
+size_t TokenStream::size() const {
+    return mTypes.size();
+}
+
+Token::Type TokenStream::getType(size_t index) const {
+    return mTypes[clamp(index)];
+}
+
+Token TokenStream::get(size_t index) const {
+    index = clamp(index);
+
+    core::Position position{mOffsets[index]};
+    std::string_view lexeme =
+        mSource.substr(mOffsets[index], mLengths[index]);
+
+    if (mValues[index].has_value()) {
+        return Token{
+            position,
+            lexeme,
+            mTypes[index],
+            *mValues[index]
+        };
+    }
+
+    return Token{position, lexeme, mTypes[index]};
+}
+
+size_t TokenStream::clamp(size_t index) const {
+    core::abort_if(mTypes.empty(), "token stream is empty");
+
+    return index < mTypes.size() ? index : mTypes.size() - 1;
+}
+
+}  // namespace PArL
@@ -0,0 +1,55 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// parl
+#include <lexer/Lexer.hpp>
+#include <parl/Token.hpp>
+#include <parl/Value.hpp>
+
+namespace PArL {
+
+// NOTE: a token stream is a whole source lexed up front. The
+// tokens are kept as parallel arrays, one per field, so that
+// the parser can look at any token by index and checking a
+// kind only touches the array of kinds. Tokens are put back
+// together on demand, their lexemes viewing the source.
+
+class TokenStream {
+   public:
+    // the lexer has to be given the same source beforehand,
+    // lexing stops after the end of file token. With more
+    // than one thread the source is lexed in parallel.
+    void fill(
+        Lexer& lexer,
+        std::string_view source,
+        size_t noOfThreads = 1
+    );
+
+    void clear();
+
+    [[nodiscard]] size_t size() const;
+
+    // indices past the end refer to the end of file token
+    [[nodiscard]] Token::Type getType(size_t index) const;
+    [[nodiscard]] Token get(size_t index) const;
+
+   private:
+    void push(Token const& token);
+
+    [[nodiscard]] size_t clamp(size_t index) const;
+
+    std::string_view mSource{};
+
+    std::vector<Token::Type> mTypes{};
+    std::vector<uint32_t> mOffsets{};
+    std::vector<uint32_t> mLengths{};
+    std::vector<std::optional<Value>> mValues{};
+};
+
+}  // namespace PArL
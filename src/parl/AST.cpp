@@ -1,338 +1,459 @@
 // parl
 #include <parl/AST.hpp>
+#include <parl/Stack.hpp>
 
 namespace PArL::core {
 
 Type::Type(
     const Base &primitive,
     bool isArray,
-    std::unique_ptr<IntegerLiteral> size
+    IntegerLiteral *size
 )
-    : base(primitive),
+    : Node(NodeKind::TYPE),
+      base(primitive),
       isArray(isArray),
-      size(std::move(size)) {
+      size(size) {
 }
 
 void Type::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 void Expr::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-PadWidth::PadWidth() {
+PadWidth::PadWidth()
+    : Literal(NodeKind::PAD_WIDTH) {
 }
 
 void PadWidth::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-PadHeight::PadHeight() {
+PadHeight::PadHeight()
+    : Literal(NodeKind::PAD_HEIGHT) {
 }
 
 void PadHeight::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 PadRead::PadRead(
-    std::unique_ptr<Expr> x,
-    std::unique_ptr<Expr> y
+    Expr *x,
+    Expr *y
 )
-    : x(std::move(x)), y(std::move(y)) {
+    : Literal(NodeKind::PAD_READ),
+      x(x),
+      y(y) {
 }
 
 void PadRead::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-PadRandomInt::PadRandomInt(std::unique_ptr<Expr> max)
-    : max(std::move(max)) {
+PadRandomInt::PadRandomInt(Expr *max)
+    : Literal(NodeKind::PAD_RANDOM_INT),
+      max(max) {
 }
 
 void PadRandomInt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 BooleanLiteral::BooleanLiteral(bool value)
-    : value(value) {
+    : Literal(NodeKind::BOOLEAN_LITERAL),
+      value(value) {
 }
 
 void BooleanLiteral::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 IntegerLiteral::IntegerLiteral(int value)
-    : value(value) {
+    : Literal(NodeKind::INTEGER_LITERAL),
+      value(value) {
 }
 
 void IntegerLiteral::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 FloatLiteral::FloatLiteral(float value)
-    : value(value) {
+    : Literal(NodeKind::FLOAT_LITERAL),
+      value(value) {
 }
 
 void FloatLiteral::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 ColorLiteral::ColorLiteral(const Color &value)
-    : value(value) {
+    : Literal(NodeKind::COLOR_LITERAL),
+      value(value) {
 }
 
 void ColorLiteral::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 ArrayLiteral::ArrayLiteral(
-    std::vector<std::unique_ptr<Expr>> exprs
+    std::vector<Expr *> exprs
 )
-    : exprs(std::move(exprs)) {
+    : Literal(NodeKind::ARRAY_LITERAL),
+      exprs(std::move(exprs)) {
 }
 
 void ArrayLiteral::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-Variable::Variable(std::string identifier)
-    : identifier(std::move(identifier)) {
+Variable::Variable(Atom identifier)
+    : Reference(NodeKind::VARIABLE),
+      identifier(identifier) {
 }
 
 void Variable::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 ArrayAccess::ArrayAccess(
-    std::string identifier,
-    std::unique_ptr<Expr> index
+    Atom identifier,
+    Expr *index
 )
-    : identifier(std::move(identifier)),
-      index(std::move(index)) {
+    : Reference(NodeKind::ARRAY_ACCESS),
+      identifier(identifier),
+      index(index) {
 }
 
 void ArrayAccess::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 FunctionCall::FunctionCall(
-    std::string identifier,
-    std::vector<std::unique_ptr<Expr>> params
+    Atom identifier,
+    std::vector<Expr *> params
 )
-    : identifier(std::move(identifier)),
+    : Reference(NodeKind::FUNCTION_CALL),
+      identifier(identifier),
       params(std::move(params)) {
 }
 
 void FunctionCall::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-SubExpr::SubExpr(std::unique_ptr<Expr> subExpr)
-    : subExpr(std::move(subExpr)) {
+SubExpr::SubExpr(Expr *subExpr)
+    : Expr(NodeKind::SUB_EXPR),
+      subExpr(subExpr) {
 }
 
 void SubExpr::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 Binary::Binary(
-    std::unique_ptr<Expr> left,
+    Expr *left,
     Operation op,
-    std::unique_ptr<Expr> right
+    Expr *right
 )
-    : left(std::move(left)),
+    : Expr(NodeKind::BINARY),
+      left(left),
       op(op),
-      right(std::move(right)) {
+      right(right) {
 }
 
 void Binary::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-Unary::Unary(Operation op, std::unique_ptr<Expr> expr)
-    : op(op), expr(std::move(expr)) {
+Unary::Unary(Operation op, Expr *expr)
+    : Expr(NodeKind::UNARY),
+      op(op),
+      expr(expr) {
 }
 
 void Unary::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 Assignment::Assignment(
-    std::string identifier,
-    std::unique_ptr<Expr> index,
-    std::unique_ptr<Expr> expr
+    Atom identifier,
+    Expr *index,
+    Expr *expr
 )
-    : identifier(std::move(identifier)),
-      index(std::move(index)),
-      expr(std::move(expr)) {
+    : Stmt(NodeKind::ASSIGNMENT),
+      identifier(identifier),
+      index(index),
+      expr(expr) {
 }
 
 void Assignment::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 VariableDecl::VariableDecl(
-    std::string identifier,
-    std::unique_ptr<Type> type,
-    std::unique_ptr<Expr> expr
+    Atom identifier,
+    Type *type,
+    Expr *expr
 )
-    : identifier(std::move(identifier)),
-      type(std::move(type)),
-      expr(std::move(expr)) {
+    : Stmt(NodeKind::VARIABLE_DECL),
+      identifier(identifier),
+      type(type),
+      expr(expr) {
 }
 
 void VariableDecl::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-PrintStmt::PrintStmt(std::unique_ptr<Expr> expr)
-    : expr(std::move(expr)) {
+PrintStmt::PrintStmt(Expr *expr)
+    : Stmt(NodeKind::PRINT),
+      expr(expr) {
 }
 
 void PrintStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-DelayStmt::DelayStmt(std::unique_ptr<Expr> expr)
-    : expr(std::move(expr)) {
+DelayStmt::DelayStmt(Expr *expr)
+    : Stmt(NodeKind::DELAY),
+      expr(expr) {
 }
 
 void DelayStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 WriteBoxStmt::WriteBoxStmt(
-    std::unique_ptr<Expr> x,
-    std::unique_ptr<Expr> y,
-    std::unique_ptr<Expr> w,
-    std::unique_ptr<Expr> h,
-    std::unique_ptr<Expr> color
+    Expr *x,
+    Expr *y,
+    Expr *w,
+    Expr *h,
+    Expr *color
 )
-    : x(std::move(x)),
-      y(std::move(y)),
-      w(std::move(w)),
-      h(std::move(h)),
-      color(std::move(color)) {
+    : Stmt(NodeKind::WRITE_BOX),
+      x(x),
+      y(y),
+      w(w),
+      h(h),
+      color(color) {
 }
 
 void WriteBoxStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 WriteStmt::WriteStmt(
-    std::unique_ptr<Expr> x,
-    std::unique_ptr<Expr> y,
-    std::unique_ptr<Expr> color
+    Expr *x,
+    Expr *y,
+    Expr *color
 )
-    : x(std::move(x)),
-      y(std::move(y)),
-      color(std::move(color)) {
+    : Stmt(NodeKind::WRITE),
+      x(x),
+      y(y),
+      color(color) {
 }
 
 void WriteStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-ClearStmt::ClearStmt(std::unique_ptr<Expr> color)
-    : color(std::move(color)) {
+ClearStmt::ClearStmt(Expr *color)
+    : Stmt(NodeKind::CLEAR),
+      color(color) {
 }
 
 void ClearStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-Block::Block(std::vector<std::unique_ptr<Stmt>> stmts)
-    : stmts(std::move(stmts)) {
+Block::Block(std::vector<Stmt *> stmts)
+    : Stmt(NodeKind::BLOCK),
+      stmts(std::move(stmts)) {
 }
 
 void Block::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 FormalParam::FormalParam(
-    std::string identifier,
-    std::unique_ptr<Type> type
+    Atom identifier,
+    Type *type
 )
-    : identifier(std::move(identifier)),
-      type(std::move(type)) {
+    : Node(NodeKind::FORMAL_PARAM),
+      identifier(identifier),
+      type(type) {
 }
 
 void FormalParam::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 FunctionDecl::FunctionDecl(
-    std::string identifier,
-    std::vector<std::unique_ptr<FormalParam>> params,
-    std::unique_ptr<Type> type,
-    std::unique_ptr<Block> block
+    Atom identifier,
+    std::vector<FormalParam *> params,
+    Type *type,
+    Block *block
 )
-    : identifier(std::move(identifier)),
+    : Stmt(NodeKind::FUNCTION_DECL),
+      identifier(identifier),
       params(std::move(params)),
-      type(std::move(type)),
-      block(std::move(block)) {
+      type(type),
+      block(block) {
 }
 
 void FunctionDecl::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 IfStmt::IfStmt(
-    std::unique_ptr<Expr> cond,
-    std::unique_ptr<Block> thenBlock,
-    std::unique_ptr<Block> elseBlock
+    Expr *cond,
+    Block *thenBlock,
+    Block *elseBlock
 )
-    : cond(std::move(cond)),
-      thenBlock(std::move(thenBlock)),
-      elseBlock(std::move(elseBlock)) {
+    : Stmt(NodeKind::IF),
+      cond(cond),
+      thenBlock(thenBlock),
+      elseBlock(elseBlock) {
 }
 
 void IfStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 ForStmt::ForStmt(
-    std::unique_ptr<VariableDecl> decl,
-    std::unique_ptr<Expr> cond,
-    std::unique_ptr<Assignment> assignment,
-    std::unique_ptr<Block> block
+    VariableDecl *decl,
+    Expr *cond,
+    Assignment *assignment,
+    Block *block
 )
-    : decl(std::move(decl)),
-      cond(std::move(cond)),
-      assignment(std::move(assignment)),
-      block(std::move(block)) {
+    : Stmt(NodeKind::FOR),
+      decl(decl),
+      cond(cond),
+      assignment(assignment),
+      block(block) {
 }
 
 void ForStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
 WhileStmt::WhileStmt(
-    std::unique_ptr<Expr> cond,
-    std::unique_ptr<Block> block
+    Expr *cond,
+    Block *block
 )
-    : cond(std::move(cond)), block(std::move(block)) {
+    : Stmt(NodeKind::WHILE),
+      cond(cond),
+      block(block) {
 }
 
 void WhileStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-ReturnStmt::ReturnStmt(std::unique_ptr<Expr> expr)
-    : expr(std::move(expr)) {
+ReturnStmt::ReturnStmt(Expr *expr)
+    : Stmt(NodeKind::RETURN),
+      expr(expr) {
 }
 
 void ReturnStmt::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
 }
 
-Program::Program(std::vector<std::unique_ptr<Stmt>> stmts)
-    : stmts(std::move(stmts)) {
+Program::Program(std::vector<Stmt *> stmts)
+    : Node(NodeKind::PROGRAM),
+      stmts(std::move(stmts)) {
 }
 
 void Program::accept(Visitor *visitor) {
-    visitor->visit(this);
+    ensureStack([&] {
+        visitor->visit(this);
+    });
+}
+
+Tree::Tree(
+    std::unique_ptr<Arena> arena,
+    Program *program,
+    std::unique_ptr<FlatTree> flat
+)
+    : mArena(std::move(arena)),
+      mProgram(program),
+      mFlat(std::move(flat)) {
+}
+
+Program *Tree::get() const {
+    return mProgram;
+}
+
+Program *Tree::operator->() const {
+    return mProgram;
+}
+
+FlatTree const &Tree::flat() const {
+    return *mFlat;
 }
 
 }  // namespace PArL::core
@@ -1,7 +1,9 @@
 #pragma once
 
 // parl
+#include <parl/Arena.hpp>
 #include <parl/Core.hpp>
+#include <parl/FlatAST.hpp>
 #include <parl/Visitor.hpp>
 
 // std
@@ -11,31 +13,50 @@
 
 namespace PArL::core {
 
+// NOTE: nodes are allocated from the arena of the tree they
+// belong to and refer to their children by plain pointers,
+// the tree releases them all at once. Nodes are never
+// deleted on their own, so most are trivially destructible
+// and cost the arena nothing to release.
+
 struct Node {
     virtual void accept(Visitor*) = 0;
 
-    virtual ~Node() = default;
+    const NodeKind kind;
+    Position position{0};
+    // the node which stands for it in the flat tree of the
+    // tree it belongs to
+    NodeId flatId{NO_NODE};
+
+   protected:
+    explicit Node(NodeKind kind)
+        : kind(kind) {
+    }
 
-    Position position{0, 0};
+    ~Node() = default;
 };
 
 struct Type : public Node {
-    explicit Type(const Base&, bool, std::unique_ptr<IntegerLiteral>);
+    explicit Type(const Base&, bool, IntegerLiteral*);
 
     void accept(Visitor*) override;
 
     const Base base;
     const bool isArray;
-    std::unique_ptr<IntegerLiteral> size;
+    IntegerLiteral* size;
 };
 
 struct Expr : public Node {
+    using Node::Node;
+
     void accept(Visitor*) override;
 
-    std::optional<std::unique_ptr<Type>> type{};
+    std::optional<Type*> type{};
 };
 
-struct Literal : public Expr {};
+struct Literal : public Expr {
+    using Expr::Expr;
+};
 
 struct PadWidth : public Literal {
     explicit PadWidth();
@@ -50,20 +71,20 @@ struct PadHeight : public Literal {
 };
 
 struct PadRead : public Literal {
-    explicit PadRead(std::unique_ptr<Expr>, std::unique_ptr<Expr>);
+    explicit PadRead(Expr*, Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> x;
-    std::unique_ptr<Expr> y;
+    Expr* x;
+    Expr* y;
 };
 
 struct PadRandomInt : public Literal {
-    explicit PadRandomInt(std::unique_ptr<Expr>);
+    explicit PadRandomInt(Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> max;
+    Expr* max;
 };
 
 struct BooleanLiteral : public Literal {
@@ -99,209 +120,237 @@ struct ColorLiteral : public Literal {
 };
 
 struct ArrayLiteral : public Literal {
-    explicit ArrayLiteral(std::vector<
-                          std::unique_ptr<Expr>>);
+    explicit ArrayLiteral(std::vector<Expr*>);
 
     void accept(Visitor*) override;
 
-    std::vector<std::unique_ptr<Expr>> exprs;
+    std::vector<Expr*> exprs;
 };
 
-struct Reference : public Expr {};
+struct Reference : public Expr {
+    using Expr::Expr;
+};
 
 struct Variable : public Reference {
-    explicit Variable(std::string);
+    explicit Variable(Atom);
 
     void accept(Visitor*) override;
 
-    const std::string identifier;
+    const Atom identifier;
 };
 
 struct ArrayAccess : public Reference {
-    explicit ArrayAccess(std::string, std::unique_ptr<Expr>);
+    explicit ArrayAccess(Atom, Expr*);
 
     void accept(Visitor*) override;
 
-    const std::string identifier;
-    std::unique_ptr<Expr> index;
+    const Atom identifier;
+    Expr* index;
 };
 
 struct FunctionCall : public Reference {
-    explicit FunctionCall(std::string, std::vector<std::unique_ptr<Expr>>);
+    explicit FunctionCall(Atom, std::vector<Expr*>);
 
     void accept(Visitor*) override;
 
-    const std::string identifier;
-    std::vector<std::unique_ptr<Expr>> params;
+    const Atom identifier;
+    std::vector<Expr*> params;
 };
 
 struct SubExpr : public Expr {
-    explicit SubExpr(std::unique_ptr<Expr>);
+    explicit SubExpr(Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> subExpr;
+    Expr* subExpr;
 };
 
 struct Binary : public Expr {
-    explicit Binary(std::unique_ptr<Expr>, Operation, std::unique_ptr<Expr>);
+    explicit Binary(Expr*, Operation, Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> left;
+    Expr* left;
     const Operation op;
-    std::unique_ptr<Expr> right;
+    Expr* right;
 };
 
 struct Unary : public Expr {
-    explicit Unary(Operation, std::unique_ptr<Expr>);
+    explicit Unary(Operation, Expr*);
 
     void accept(Visitor*) override;
 
     const Operation op;
-    std::unique_ptr<Expr> expr;
+    Expr* expr;
 };
 
-struct Stmt : public Node {};
+struct Stmt : public Node {
+    using Node::Node;
+};
 
 struct Assignment : public Stmt {
-    explicit Assignment(std::string, std::unique_ptr<Expr>, std::unique_ptr<Expr>);
+    explicit Assignment(Atom, Expr*, Expr*);
 
     void accept(Visitor*) override;
 
-    const std::string identifier;
-    std::unique_ptr<Expr> index;
-    std::unique_ptr<Expr> expr;
+    const Atom identifier;
+    Expr* index;
+    Expr* expr;
 };
 
 struct VariableDecl : public Stmt {
-    explicit VariableDecl(std::string, std::unique_ptr<Type>, std::unique_ptr<Expr>);
+    explicit VariableDecl(Atom, Type*, Expr*);
 
     void accept(Visitor*) override;
 
-    const std::string identifier;
-    std::unique_ptr<Type> type;
-    std::unique_ptr<Expr> expr;
+    const Atom identifier;
+    Type* type;
+    Expr* expr;
 };
 
 struct PrintStmt : public Stmt {
-    explicit PrintStmt(std::unique_ptr<Expr>);
+    explicit PrintStmt(Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> expr;
+    Expr* expr;
 };
 
 struct DelayStmt : public Stmt {
-    explicit DelayStmt(std::unique_ptr<Expr>);
+    explicit DelayStmt(Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> expr;
+    Expr* expr;
 };
 
 struct WriteBoxStmt : public Stmt {
-    explicit WriteBoxStmt(std::unique_ptr<Expr>, std::unique_ptr<Expr>, std::unique_ptr<Expr>, std::unique_ptr<Expr>, std::unique_ptr<Expr>);
+    explicit WriteBoxStmt(Expr*, Expr*, Expr*, Expr*, Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> x;
-    std::unique_ptr<Expr> y;
-    std::unique_ptr<Expr> w;
-    std::unique_ptr<Expr> h;
-    std::unique_ptr<Expr> color;
+    Expr* x;
+    Expr* y;
+    Expr* w;
+    Expr* h;
+    Expr* color;
 };
 
 struct WriteStmt : public Stmt {
-    explicit WriteStmt(std::unique_ptr<Expr>, std::unique_ptr<Expr>, std::unique_ptr<Expr>);
+    explicit WriteStmt(Expr*, Expr*, Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> x;
-    std::unique_ptr<Expr> y;
-    std::unique_ptr<Expr> color;
+    Expr* x;
+    Expr* y;
+    Expr* color;
 };
 
 struct ClearStmt : public Stmt {
-    explicit ClearStmt(std::unique_ptr<Expr>);
+    explicit ClearStmt(Expr*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> color;
+    Expr* color;
 };
 
 struct Block : public Stmt {
-    explicit Block(std::vector<std::unique_ptr<Stmt>>);
+    explicit Block(std::vector<Stmt*>);
 
     void accept(Visitor*) override;
 
-    std::vector<std::unique_ptr<Stmt>> stmts;
+    std::vector<Stmt*> stmts;
 };
 
 struct FormalParam : public Node {
-    explicit FormalParam(std::string, std::unique_ptr<Type>);
+    explicit FormalParam(Atom, Type*);
 
     void accept(Visitor*) override;
 
-    const std::string identifier;
-    std::unique_ptr<Type> type;
+    const Atom identifier;
+    Type* type;
 };
 
 struct FunctionDecl : public Stmt {
-    explicit FunctionDecl(std::string, std::vector<std::unique_ptr<FormalParam>>, std::unique_ptr<Type>, std::unique_ptr<Block>);
+    explicit FunctionDecl(Atom, std::vector<FormalParam*>, Type*, Block*);
 
     void accept(Visitor*) override;
 
-    const std::string identifier;
-    std::vector<std::unique_ptr<FormalParam>> params;
-    std::unique_ptr<Type> type;
-    std::unique_ptr<Block> block;
+    const Atom identifier;
+    std::vector<FormalParam*> params;
+    Type* type;
+    Block* block;
+    // where a lazy parser keeps the body it left out, until
+    // the body is parsed
+    std::optional<size_t> deferredBody{};
 };
 
 struct IfStmt : public Stmt {
-    explicit IfStmt(std::unique_ptr<Expr>, std::unique_ptr<Block>, std::unique_ptr<Block>);
+    explicit IfStmt(Expr*, Block*, Block*);
 
     void accept(Visitor*) override;
 
-    std::unique_ptr<Expr> cond;
-    std::unique_ptr<Block> thenBlock;
-    std::unique_ptr<Block> elseBlock;
+    Expr* cond;
+    Block* thenBlock;
+    Block* elseBlock;
 };
 
 struct ForStmt : public Stmt {
-    explicit ForStmt(std::unique_ptr<VariableDecl>, std::unique_ptr<Expr>, std::unique_ptr<Assignment>, std::unique_ptr<Block>);
+    explicit ForStmt(VariableDecl*, Expr*, Assignment*, Block*);
 
     void accept(Visitor* visitor) override;
 
-    std::unique_ptr<VariableDecl> decl;
-    std::unique_ptr<Expr> cond;
-    std::unique_ptr<Assignment> assignment;
-    std::unique_ptr<Block> block;
+    VariableDecl* decl;
+    Expr* cond;
+    Assignment* assignment;
+    Block* block;
 };
 
 struct WhileStmt : public Stmt {
-    explicit WhileStmt(std::unique_ptr<Expr>, std::unique_ptr<Block>);
+    explicit WhileStmt(Expr*, Block*);
 
     void accept(Visitor* visitor) override;
 
-    std::unique_ptr<Expr> cond;
-    std::unique_ptr<Block> block;
+    Expr* cond;
+    Block* block;
 };
 
 struct ReturnStmt : public Stmt {
-    explicit ReturnStmt(std::unique_ptr<Expr>);
+    explicit ReturnStmt(Expr*);
 
     void accept(Visitor* visitor) override;
 
-    std::unique_ptr<Expr> expr;
+    Expr* expr;
 };
 
 struct Program : public Node {
-    explicit Program(std::vector<std::unique_ptr<Stmt>>);
+    explicit Program(std::vector<Stmt*>);
 
     void accept(Visitor* visitor) override;
 
-    std::vector<std::unique_ptr<Stmt>> stmts;
+    std::vector<Stmt*> stmts;
+};
+
+// NOTE: a tree holds both forms of the program, the passes
+// walk the nodes and read expressions out of the flat tree
+// by the flat id of their node
+
+class Tree {
+   public:
+    Tree(
+        std::unique_ptr<Arena> arena,
+        Program* program,
+        std::unique_ptr<FlatTree> flat
+    );
+
+    [[nodiscard]] Program* get() const;
+    Program* operator->() const;
+    [[nodiscard]] FlatTree const& flat() const;
+
+   private:
+    std::unique_ptr<Arena> mArena;
+    Program* mProgram;
+    std::unique_ptr<FlatTree> mFlat;
 };
 
 }  // namespace PArL::core
@@ -0,0 +1,77 @@
+// parl
+#include <parl/Arena.hpp>
+
+namespace PArL::core {
+
+Arena::~Arena() {
+    for (auto it = mDestructors.rbegin();
+         it != mDestructors.rend();
+         it++) {
+        auto [object, destroy] = *it;
+
+        destroy(object);
+    }
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    mSize += size;
+
+    // anything too large for a block gets one of its own,
+    // the current block is kept for what comes after
+    if (size + alignment > ARENA_BLOCK_SIZE) {
+        void* memory = newBlock(size + alignment);
+        size_t space = size + alignment;
+
+        return std::align(alignment, size, memory, space);
+    }
+
+    void* memory = mCursor;
+
+    if (std::align(alignment, size, memory, mAvailable) ==
+        nullptr) {
+        mCursor = newBlock(ARENA_BLOCK_SIZE);
+        mAvailable = ARENA_BLOCK_SIZE;
+
+        memory = mCursor;
+
+        std::align(alignment, size, memory, mAvailable);
+    }
+
+    mCursor = static_cast<std::byte*>(memory) + size;
+    mAvailable -= size;
+
+    return memory;
+}
+
+size_t Arena::size() const {
+    return mSize;
+}
+
+void Arena::adopt(Arena& other) {
+    for (auto& block : other.mBlocks) {
+        mBlocks.push_back(std::move(block));
+    }
+
+    mDestructors.insert(
+        mDestructors.end(),
+        other.mDestructors.begin(),
+        other.mDestructors.end()
+    );
+
+    mSize += other.mSize;
+
+    other.mBlocks.clear();
+    other.mDestructors.clear();
+    other.mCursor = nullptr;
+    other.mAvailable = 0;
+    other.mSize = 0;
+}
+
+std::byte* Arena::newBlock(size_t size) {
+    // the memory is left uninitialised
+    mBlocks.emplace_back(new std::byte[size]);
+
+    return mBlocks.back().get();
+}
+
+}  // namespace PArL::core
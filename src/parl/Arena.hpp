@@ -0,0 +1,68 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// definitions
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+namespace PArL::core {
+
+// NOTE: an arena hands out memory by bumping a pointer
+// through large blocks and releases it all at once when it
+// is destroyed. Objects which need their destructor run,
+// e.g. because they hold a vector, have it run then, in the
+// reverse order of their construction, the rest are simply
+// dropped with their blocks.
+
+class Arena {
+   public:
+    Arena() = default;
+    ~Arena();
+
+    Arena(Arena const&) = delete;
+    Arena& operator=(Arena const&) = delete;
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        void* memory = allocate(sizeof(T), alignof(T));
+
+        T* object =
+            new (memory) T(std::forward<Args>(args)...);
+
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            mDestructors.emplace_back(object, [](void* object) {
+                static_cast<T*>(object)->~T();
+            });
+        }
+
+        return object;
+    }
+
+    [[nodiscard]] void* allocate(size_t size, size_t alignment);
+
+    // the number of bytes handed out so far
+    [[nodiscard]] size_t size() const;
+
+    // takes over the objects of another arena, which is left
+    // empty, so they live as long as this one
+    void adopt(Arena& other);
+
+   private:
+    std::byte* newBlock(size_t size);
+
+    std::vector<std::unique_ptr<std::byte[]>> mBlocks{};
+    void* mCursor{nullptr};
+    size_t mAvailable{0};
+    size_t mSize{0};
+
+    std::vector<std::pair<void*, void (*)(void*)>>
+        mDestructors{};
+};
+
+}  // namespace PArL::core
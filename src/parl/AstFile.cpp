@@ -0,0 +1,250 @@
+// parl
+#include <parl/AstFile.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// definitions
+#define BYTE_ORDER_MARK (0x01020304)
+
+namespace PArL::core {
+
+namespace {
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t noOfNodes;
+    uint32_t noOfLists;
+    uint32_t noOfLines;
+    uint32_t noOfNames;
+    uint32_t noOfBytes;
+    NodeId root;
+};
+
+static_assert(
+    std::is_trivially_copyable_v<FlatTree::Node>,
+    "flat nodes are written out as they are"
+);
+
+static_assert(
+    sizeof(Header) % sizeof(uint32_t) == 0 &&
+        sizeof(FlatTree::Node) % sizeof(uint32_t) == 0,
+    "every section of an ast file starts on a word"
+);
+
+template <typename T>
+void writeArray(
+    std::ostream &out,
+    std::vector<T> const &array
+) {
+    out.write(
+        reinterpret_cast<char const *>(array.data()),
+        static_cast<std::streamsize>(
+            array.size() * sizeof(T)
+        )
+    );
+}
+
+template <typename T>
+std::vector<T> readArray(
+    char const *&cursor,
+    uint32_t length
+) {
+    std::vector<T> array(length);
+
+    if (length > 0) {
+        std::memcpy(
+            array.data(),
+            cursor,
+            length * sizeof(T)
+        );
+    }
+
+    cursor += length * sizeof(T);
+
+    return array;
+}
+
+}  // namespace
+
+AstFile::AstFile(
+    FlatTree tree,
+    std::vector<Atom> atoms,
+    LineMap lineMap
+)
+    : mTree(std::move(tree)),
+      mAtoms(std::move(atoms)),
+      mLineMap(std::move(lineMap)) {
+}
+
+bool AstFile::write(
+    std::ostream &out,
+    FlatTree const &tree,
+    Interner const &interner,
+    LineMap const &lineMap
+) {
+    std::vector<uint32_t> ends{};
+    std::string bytes{};
+
+    ends.reserve(interner.size());
+
+    for (size_t i = 0; i < interner.size(); i++) {
+        Atom atom{static_cast<uint32_t>(i)};
+
+        bytes += interner.name(atom);
+
+        if (bytes.size() > UINT32_MAX) {
+            return false;
+        }
+
+        ends.push_back(static_cast<uint32_t>(bytes.size()));
+    }
+
+    if (tree.lists().size() > UINT32_MAX ||
+        lineMap.lineStarts().size() > UINT32_MAX) {
+        return false;
+    }
+
+    Header header{};
+
+    std::memcpy(
+        header.magic,
+        AST_FILE_MAGIC,
+        sizeof(header.magic)
+    );
+
+    header.version = AST_FILE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.noOfNodes = static_cast<uint32_t>(tree.size());
+    header.noOfLists =
+        static_cast<uint32_t>(tree.lists().size());
+    header.noOfLines =
+        static_cast<uint32_t>(lineMap.lineStarts().size());
+    header.noOfNames = static_cast<uint32_t>(ends.size());
+    header.noOfBytes = static_cast<uint32_t>(bytes.size());
+    header.root = tree.root();
+
+    out.write(
+        reinterpret_cast<char const *>(&header),
+        sizeof(header)
+    );
+
+    writeArray(out, tree.nodes());
+    writeArray(out, tree.lists());
+    writeArray(out, lineMap.lineStarts());
+    writeArray(out, ends);
+
+    out.write(
+        bytes.data(),
+        static_cast<std::streamsize>(bytes.size())
+    );
+
+    return out.good();
+}
+
+std::optional<AstFile> AstFile::read(
+    std::string_view bytes,
+    Interner &interner
+) {
+    Header header{};
+
+    if (bytes.size() < sizeof(header)) {
+        return {};
+    }
+
+    std::memcpy(&header, bytes.data(), sizeof(header));
+
+    if (std::memcmp(
+            header.magic,
+            AST_FILE_MAGIC,
+            sizeof(header.magic)
+        ) != 0 ||
+        header.version != AST_FILE_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK) {
+        return {};
+    }
+
+    // the lengths are 32 bit, so none of this can overflow
+    uint64_t size =
+        sizeof(header) +
+        uint64_t{header.noOfNodes} *
+            sizeof(FlatTree::Node) +
+        (uint64_t{header.noOfLists} + header.noOfLines +
+         header.noOfNames) *
+            sizeof(uint32_t) +
+        header.noOfBytes;
+
+    if (size != bytes.size()) {
+        return {};
+    }
+
+    char const *cursor = bytes.data() + sizeof(header);
+
+    auto nodes =
+        readArray<FlatTree::Node>(cursor, header.noOfNodes);
+    auto lists =
+        readArray<NodeId>(cursor, header.noOfLists);
+    auto lines =
+        readArray<uint32_t>(cursor, header.noOfLines);
+    auto ends =
+        readArray<uint32_t>(cursor, header.noOfNames);
+
+    if (lines.empty() || lines.front() != 0 ||
+        !std::is_sorted(lines.begin(), lines.end())) {
+        return {};
+    }
+
+    uint32_t noOfBytes = ends.empty() ? 0 : ends.back();
+
+    if (!std::is_sorted(ends.begin(), ends.end()) ||
+        noOfBytes != header.noOfBytes) {
+        return {};
+    }
+
+    std::vector<Atom> atoms{};
+    uint32_t start = 0;
+
+    atoms.reserve(ends.size());
+
+    for (uint32_t end : ends) {
+        atoms.push_back(
+            interner.intern({cursor + start, end - start})
+        );
+
+        start = end;
+    }
+
+    return AstFile{
+        FlatTree{
+            std::move(nodes),
+            std::move(lists),
+            header.root
+        },
+        std::move(atoms),
+        LineMap{std::move(lines)}
+    };
+}
+
+FlatTree const &AstFile::tree() const {
+    return mTree;
+}
+
+FlatTree AstFile::takeTree() {
+    return std::move(mTree);
+}
+
+std::vector<Atom> const &AstFile::atoms() const {
+    return mAtoms;
+}
+
+LineMap const &AstFile::lineMap() const {
+    return mLineMap;
+}
+
+}  // namespace PArL::core
@@ -0,0 +1,85 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// parl
+#include <parl/Core.hpp>
+#include <parl/FlatAST.hpp>
+#include <parl/Interner.hpp>
+#include <parl/LineMap.hpp>
+
+// definitions
+#define AST_FILE_MAGIC ("PArL AST")
+// bump whenever the kinds or layout of flat nodes change
+#define AST_FILE_VERSION (1)
+
+namespace PArL::core {
+
+// NOTE: an ast file holds a flat tree as it is laid out in
+// memory, so it can be mapped and copied out a section at a
+// time rather than parsed. Every section is a run of 32 bit
+// words, in the byte order of the machine which wrote it:
+//
+//   header   magic, version, byte order mark and the length
+//            of each of the sections below, then the root
+//   nodes    the node array of the flat tree
+//   lists    the list array of the flat tree
+//   lines    the line starts of the source it was parsed
+//            from, for diagnostics
+//   names    the end of the name of each atom in the bytes
+//   bytes    the names of the atoms, one after the other
+//
+// A file is only read back on a machine and by a compiler
+// which agree with it on all of the above.
+//
+// Reading only spares the lexing and the parsing. The node
+// hierarchy is then rebuilt from the flat tree by an
+// Unflattener, which checks every node as it goes, so a
+// loaded program still costs a pass over all of its nodes.
+// The flat tree is written in source order, so the same
+// source gives the same bytes however it was parsed.
+
+class AstFile {
+   public:
+    AstFile(
+        FlatTree tree,
+        std::vector<Atom> atoms,
+        LineMap lineMap
+    );
+
+    // returns whether all of it was written
+    static bool write(
+        std::ostream& out,
+        FlatTree const& tree,
+        Interner const& interner,
+        LineMap const& lineMap
+    );
+
+    // the names are interned as they are read, returns
+    // nothing when the bytes are not an ast file which can
+    // be read back
+    static std::optional<AstFile> read(
+        std::string_view bytes,
+        Interner& interner
+    );
+
+    [[nodiscard]] FlatTree const& tree() const;
+    // leaves the file without a tree
+    [[nodiscard]] FlatTree takeTree();
+    // the atom in the interner read into which each atom in
+    // the tree stands for
+    [[nodiscard]] std::vector<Atom> const& atoms() const;
+    [[nodiscard]] LineMap const& lineMap() const;
+
+   private:
+    FlatTree mTree;
+    std::vector<Atom> mAtoms;
+    LineMap mLineMap;
+};
+
+}  // namespace PArL::core
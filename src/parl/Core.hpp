@@ -4,6 +4,7 @@
 #include <fmt/core.h>
 
 // std
+#include <cstdint>
 #include <sstream>
 #include <stack>
 #include <variant>
@@ -40,23 +41,53 @@ inline void abort_if(
 }
 #endif
 
+// NOTE: a position is the byte offset of a lexeme in the
+// source, use a LineMap to recover its row and column
+
 class Position {
    public:
-    Position(int row, int col)
-        : mRow(row), mCol(col) {
+    Position(uint32_t offset)
+        : mOffset(offset) {
+    }
+
+    [[nodiscard]] uint32_t offset() const {
+        return mOffset;
+    }
+
+   private:
+    uint32_t mOffset;
+};
+
+// NOTE: an atom is an identifier interned by an Interner,
+// two atoms from the same interner are equal exactly when
+// their names are
+
+class Atom {
+   public:
+    explicit Atom(uint32_t id)
+        : mId(id) {
+    }
+
+    [[nodiscard]] uint32_t id() const {
+        return mId;
     }
 
-    [[nodiscard]] int row() const {
-        return mRow;
+    bool operator==(Atom const& other) const {
+        return mId == other.mId;
     }
 
-    [[nodiscard]] int col() const {
-        return mCol;
+    bool operator!=(Atom const& other) const {
+        return mId != other.mId;
     }
 
+    struct Hash {
+        size_t operator()(Atom const& atom) const {
+            return atom.mId;
+        }
+    };
+
    private:
-    int mRow;
-    int mCol;
+    uint32_t mId;
 };
 
 class Color {
@@ -308,6 +339,44 @@ inline std::string primitiveToString(Primitive *primitive) {
     return buffer.str();
 }
 
+// NOTE: every node type which is not abstract has a kind
+// of its own, so a pass can tell nodes apart by switching on
+// it rather than through a virtual call
+
+enum class NodeKind : uint8_t {
+    TYPE,
+    PAD_WIDTH,
+    PAD_HEIGHT,
+    PAD_READ,
+    PAD_RANDOM_INT,
+    BOOLEAN_LITERAL,
+    INTEGER_LITERAL,
+    FLOAT_LITERAL,
+    COLOR_LITERAL,
+    ARRAY_LITERAL,
+    VARIABLE,
+    ARRAY_ACCESS,
+    FUNCTION_CALL,
+    SUB_EXPR,
+    BINARY,
+    UNARY,
+    ASSIGNMENT,
+    VARIABLE_DECL,
+    PRINT,
+    DELAY,
+    WRITE_BOX,
+    WRITE,
+    CLEAR,
+    BLOCK,
+    FORMAL_PARAM,
+    FUNCTION_DECL,
+    IF,
+    FOR,
+    WHILE,
+    RETURN,
+    PROGRAM,
+};
+
 enum class Builtin {
     CLEAR,
     DELAY,
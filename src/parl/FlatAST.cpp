@@ -0,0 +1,228 @@
+// parl
+#include <parl/FlatAST.hpp>
+
+// std
+#include <cstring>
+#include <utility>
+
+namespace PArL::core {
+
+static_assert(
+    sizeof(FlatTree::Node) <= 6 * sizeof(uint32_t),
+    "flat nodes are meant to be a few words"
+);
+
+FlatTree::FlatTree(
+    std::vector<Node> nodes,
+    std::vector<NodeId> lists,
+    NodeId root
+)
+    : mNodes(std::move(nodes)),
+      mLists(std::move(lists)),
+      mRoot(root) {
+}
+
+NodeId FlatTree::add(Node const& node) {
+    abort_if(
+        mNodes.size() >= NO_NODE,
+        "flat trees hold at most {} nodes",
+        NO_NODE
+    );
+
+    mNodes.push_back(node);
+
+    return static_cast<NodeId>(mNodes.size() - 1);
+}
+
+uint32_t FlatTree::addList(std::vector<NodeId> const& nodes) {
+    auto start = static_cast<uint32_t>(mLists.size());
+
+    mLists.insert(mLists.end(), nodes.begin(), nodes.end());
+
+    return start;
+}
+
+void FlatTree::setRoot(NodeId root) {
+    mRoot = root;
+}
+
+void FlatTree::setCast(NodeId id, NodeId type) {
+    mNodes[id].cast = type;
+}
+
+void FlatTree::setListEntry(uint32_t index, NodeId id) {
+    mLists[index] = id;
+}
+
+void FlatTree::setAtom(NodeId id, Atom atom) {
+    mNodes[id].a = atom.id();
+}
+
+NodeId FlatTree::append(FlatTree const& other) {
+    abort_if(
+        other.size() >= NO_NODE - mNodes.size(),
+        "flat trees hold at most {} nodes",
+        NO_NODE
+    );
+
+    auto offset = static_cast<NodeId>(mNodes.size());
+    auto listOffset = static_cast<uint32_t>(mLists.size());
+
+    auto shift = [offset](NodeId id) {
+        return id == NO_NODE ? NO_NODE : id + offset;
+    };
+
+    mNodes.reserve(mNodes.size() + other.size());
+
+    // which operands are children, and which start a run,
+    // depends on the kind, see FlatAST.hpp
+    for (Node node : other.mNodes) {
+        node.cast = shift(node.cast);
+
+        switch (node.kind) {
+            case Kind::PAD_READ:
+            case Kind::BINARY:
+            case Kind::WHILE:
+                node.a = shift(node.a);
+                node.b = shift(node.b);
+                break;
+            case Kind::PAD_RANDOM_INT:
+            case Kind::SUB_EXPR:
+            case Kind::UNARY:
+            case Kind::PRINT:
+            case Kind::DELAY:
+            case Kind::CLEAR:
+            case Kind::RETURN:
+                node.a = shift(node.a);
+                break;
+            case Kind::TYPE:
+            case Kind::ARRAY_ACCESS:
+            case Kind::FORMAL_PARAM:
+                node.b = shift(node.b);
+                break;
+            case Kind::ASSIGNMENT:
+            case Kind::VARIABLE_DECL:
+                node.b = shift(node.b);
+                node.c = shift(node.c);
+                break;
+            case Kind::IF:
+                node.a = shift(node.a);
+                node.b = shift(node.b);
+                node.c = shift(node.c);
+                break;
+            case Kind::ARRAY_LITERAL:
+            case Kind::WRITE_BOX:
+            case Kind::WRITE:
+            case Kind::BLOCK:
+            case Kind::FOR:
+            case Kind::PROGRAM:
+                node.a += listOffset;
+                break;
+            case Kind::FUNCTION_CALL:
+            case Kind::FUNCTION_DECL:
+                node.b += listOffset;
+                break;
+            default:
+                // literals and variables have no children
+                break;
+        }
+
+        mNodes.push_back(node);
+    }
+
+    for (NodeId id : other.mLists) {
+        mLists.push_back(shift(id));
+    }
+
+    return offset;
+}
+
+NodeId FlatTree::root() const {
+    return mRoot;
+}
+
+size_t FlatTree::size() const {
+    return mNodes.size();
+}
+
+FlatTree::Node const& FlatTree::node(NodeId id) const {
+    return mNodes[id];
+}
+
+std::vector<FlatTree::Node> const& FlatTree::nodes() const {
+    return mNodes;
+}
+
+std::vector<NodeId> const& FlatTree::lists() const {
+    return mLists;
+}
+
+FlatTree::Children FlatTree::list(
+    uint32_t start,
+    uint32_t length
+) const {
+    NodeId const* begin = mLists.data() + start;
+
+    return {begin, begin + length};
+}
+
+FlatTree::Children FlatTree::children(NodeId id) const {
+    return list(mNodes[id].a, mNodes[id].b);
+}
+
+uint32_t FlatTree::fromInt(int value) {
+    return static_cast<uint32_t>(value);
+}
+
+uint32_t FlatTree::fromFloat(float value) {
+    uint32_t bits;
+
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    return bits;
+}
+
+uint32_t FlatTree::fromColor(Color value) {
+    return uint32_t{value.r()} << 16 |
+           uint32_t{value.g()} << 8 | uint32_t{value.b()};
+}
+
+int FlatTree::intValue(NodeId id) const {
+    return static_cast<int>(mNodes[id].a);
+}
+
+float FlatTree::floatValue(NodeId id) const {
+    float value;
+
+    std::memcpy(&value, &mNodes[id].a, sizeof(value));
+
+    return value;
+}
+
+Color FlatTree::colorValue(NodeId id) const {
+    uint32_t bits = mNodes[id].a;
+
+    return {
+        static_cast<uint8_t>(bits >> 16),
+        static_cast<uint8_t>(bits >> 8),
+        static_cast<uint8_t>(bits)
+    };
+}
+
+bool FlatTree::boolValue(NodeId id) const {
+    return mNodes[id].a != 0;
+}
+
+Atom FlatTree::atom(NodeId id) const {
+    return Atom{mNodes[id].a};
+}
+
+Base FlatTree::base(NodeId id) const {
+    return static_cast<Base>(mNodes[id].tag);
+}
+
+Operation FlatTree::operation(NodeId id) const {
+    return static_cast<Operation>(mNodes[id].tag);
+}
+
+}  // namespace PArL::core
@@ -0,0 +1,152 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// parl
+#include <parl/Core.hpp>
+
+// definitions
+#define NO_NODE (UINT32_MAX)
+
+namespace PArL::core {
+
+// NOTE: a flat tree holds the same program as the node
+// hierarchy in AST.hpp, but every node is a small record in
+// one contiguous array and refers to its children by index.
+// Lists of children are runs in a second array. A node is
+// told apart by its kind, the meaning of its operands
+// depends on it:
+//
+//   TYPE             tag base, a is array, b size or NO_NODE
+//   PAD_READ         a x, b y
+//   PAD_RANDOM_INT   a max
+//   *_LITERAL        a the bits of the value
+//   ARRAY_LITERAL    a, b list of expressions
+//   VARIABLE         a atom
+//   ARRAY_ACCESS     a atom, b index
+//   FUNCTION_CALL    a atom, b, c list of arguments
+//   SUB_EXPR         a expression
+//   BINARY           tag operation, a left, b right
+//   UNARY            tag operation, a expression
+//   ASSIGNMENT       a atom, b index or NO_NODE, c expression
+//   VARIABLE_DECL    a atom, b type, c expression
+//   PRINT, DELAY,
+//   CLEAR, RETURN    a expression
+//   WRITE_BOX        a, b list of x, y, w, h and color
+//   WRITE            a, b list of x, y and color
+//   BLOCK            a, b list of statements
+//   FORMAL_PARAM     a atom, b type
+//   FUNCTION_DECL    a atom, b, c list of parameters
+//                    followed by the type and the block
+//   IF               a condition, b then, c else or NO_NODE
+//   FOR              a, b list of declaration, condition,
+//                    assignment and block, the first and
+//                    third may be NO_NODE
+//   WHILE            a condition, b block
+//   PROGRAM          a, b list of statements
+//
+// where "a, b list" is the start and length of a run. Every
+// expression may also have a cast to a type.
+
+using NodeId = uint32_t;
+
+class FlatTree {
+   public:
+    // a flat node has the same kind as the node it stands
+    // for
+    using Kind = NodeKind;
+
+    struct Node {
+        Kind kind;
+        uint8_t tag{0};
+        uint32_t position{0};
+        NodeId cast{NO_NODE};
+        uint32_t a{0};
+        uint32_t b{0};
+        uint32_t c{0};
+    };
+
+    class Children {
+       public:
+        Children(NodeId const* begin, NodeId const* end)
+            : mBegin(begin), mEnd(end) {
+        }
+
+        [[nodiscard]] NodeId const* begin() const {
+            return mBegin;
+        }
+
+        [[nodiscard]] NodeId const* end() const {
+            return mEnd;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return mEnd - mBegin;
+        }
+
+        NodeId operator[](size_t index) const {
+            return mBegin[index];
+        }
+
+       private:
+        NodeId const* mBegin;
+        NodeId const* mEnd;
+    };
+
+    FlatTree() = default;
+    FlatTree(
+        std::vector<Node> nodes,
+        std::vector<NodeId> lists,
+        NodeId root
+    );
+
+    NodeId add(Node const& node);
+    // returns the start of the run, for a and b
+    uint32_t addList(std::vector<NodeId> const& nodes);
+
+    void setRoot(NodeId root);
+    void setCast(NodeId id, NodeId type);
+    // for a child made after its parent, e.g. a body which
+    // a lazy parser left for later
+    void setListEntry(uint32_t index, NodeId id);
+    // for a tree read in with atoms of another interner
+    void setAtom(NodeId id, Atom atom);
+
+    // adds the nodes and lists of another tree after these,
+    // returns by how much the ids of its nodes moved
+    NodeId append(FlatTree const& other);
+
+    [[nodiscard]] NodeId root() const;
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] Node const& node(NodeId id) const;
+    [[nodiscard]] std::vector<Node> const& nodes() const;
+    [[nodiscard]] std::vector<NodeId> const& lists() const;
+    [[nodiscard]] Children list(uint32_t start, uint32_t length)
+        const;
+
+    // the run given by the a and b operands of a node
+    [[nodiscard]] Children children(NodeId id) const;
+
+    [[nodiscard]] static uint32_t fromInt(int value);
+    [[nodiscard]] static uint32_t fromFloat(float value);
+    [[nodiscard]] static uint32_t fromColor(Color value);
+
+    [[nodiscard]] int intValue(NodeId id) const;
+    [[nodiscard]] float floatValue(NodeId id) const;
+    [[nodiscard]] Color colorValue(NodeId id) const;
+    [[nodiscard]] bool boolValue(NodeId id) const;
+    [[nodiscard]] Atom atom(NodeId id) const;
+    [[nodiscard]] Base base(NodeId id) const;
+    [[nodiscard]] Operation operation(NodeId id) const;
+
+   private:
+    std::vector<Node> mNodes{};
+    std::vector<NodeId> mLists{};
+    NodeId mRoot{NO_NODE};
+};
+
+}  // namespace PArL::core
@@ -0,0 +1,51 @@
+// parl
+#include <parl/Interner.hpp>
+
+// std
+#include <cstdint>
+
+namespace PArL::core {
+
+Atom Interner::intern(std::string_view name) {
+    auto atom = mAtoms.find(name);
+
+    if (atom != mAtoms.end())
+        return atom->second;
+
+    abort_if(
+        mNames.size() >= UINT32_MAX,
+        "cannot intern more than {} identifiers",
+        UINT32_MAX
+    );
+
+    // the deque never moves its strings, so the key can view
+    // the stored name
+    std::string const& stored = mNames.emplace_back(name);
+
+    Atom interned{static_cast<uint32_t>(mNames.size() - 1)};
+
+    mAtoms.emplace(stored, interned);
+
+    return interned;
+}
+
+std::string_view Interner::name(Atom atom) const {
+    abort_if(
+        atom.id() >= mNames.size(),
+        "atom {} was not interned",
+        atom.id()
+    );
+
+    return mNames[atom.id()];
+}
+
+size_t Interner::size() const {
+    return mNames.size();
+}
+
+void Interner::clear() {
+    mAtoms.clear();
+    mNames.clear();
+}
+
+}  // namespace PArL::core
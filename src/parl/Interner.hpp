@@ -0,0 +1,37 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// parl
+#include <parl/Core.hpp>
+
+namespace PArL::core {
+
+// NOTE: identifiers are interned by the lexer, from then on
+// they are compared and hashed as atoms and only turned back
+// into names for diagnostics and code generation. Atoms are
+// dense, the first name interned is 0, the next 1 and so on.
+// The names are owned by the interner so they outlive the
+// source they were lexed from.
+
+class Interner {
+   public:
+    Atom intern(std::string_view name);
+
+    [[nodiscard]] std::string_view name(Atom atom) const;
+
+    [[nodiscard]] size_t size() const;
+
+    void clear();
+
+   private:
+    std::unordered_map<std::string_view, Atom> mAtoms{};
+    std::deque<std::string> mNames{};
+};
+
+}  // namespace PArL::core
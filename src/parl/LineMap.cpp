@@ -0,0 +1,77 @@
+// parl
+#include <parl/LineMap.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace PArL::core {
+
+LineMap::LineMap()
+    : mLineStarts({0}) {
+}
+
+LineMap::LineMap(std::vector<uint32_t> lineStarts)
+    : mLineStarts(std::move(lineStarts)) {
+}
+
+void LineMap::build(std::string_view source) {
+    clear();
+
+    append(source, 0);
+}
+
+void LineMap::append(std::string_view bytes, uint32_t base) {
+    char const* begin = bytes.data();
+    char const* end = begin + bytes.length();
+    char const* cursor = begin;
+
+    // memchr is vectorised by the c library
+    while (cursor < end) {
+        auto const* linefeed = static_cast<char const*>(
+            std::memchr(cursor, '\n', end - cursor)
+        );
+
+        if (linefeed == nullptr)
+            break;
+
+        cursor = linefeed + 1;
+
+        mLineStarts.push_back(
+            base + static_cast<uint32_t>(cursor - begin)
+        );
+    }
+}
+
+void LineMap::clear() {
+    mLineStarts.assign({0});
+}
+
+int LineMap::row(Position position) const {
+    return static_cast<int>(lineOf(position)) + 1;
+}
+
+int LineMap::col(Position position) const {
+    return static_cast<int>(
+               position.offset() -
+               mLineStarts[lineOf(position)]
+           ) +
+           1;
+}
+
+std::vector<uint32_t> const& LineMap::lineStarts() const {
+    return mLineStarts;
+}
+
+size_t LineMap::lineOf(Position position) const {
+    auto next = std::upper_bound(
+        mLineStarts.begin(),
+        mLineStarts.end(),
+        position.offset()
+    );
+
+    return (next - mLineStarts.begin()) - 1;
+}
+
+}  // namespace PArL::core
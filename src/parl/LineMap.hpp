@@ -0,0 +1,40 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// parl
+#include <parl/Core.hpp>
+
+namespace PArL::core {
+
+// NOTE: positions are byte offsets into the source, the
+// line map turns them back into rows and columns when a
+// diagnostic or a debug print needs them. Rows and columns
+// are both counted from 1.
+
+class LineMap {
+   public:
+    LineMap();
+    explicit LineMap(std::vector<uint32_t> lineStarts);
+
+    void build(std::string_view source);
+    void append(std::string_view bytes, uint32_t base);
+    void clear();
+
+    [[nodiscard]] int row(Position position) const;
+    [[nodiscard]] int col(Position position) const;
+
+    // the offset each line starts at, the first is always 0
+    [[nodiscard]] std::vector<uint32_t> const& lineStarts()
+        const;
+
+   private:
+    [[nodiscard]] size_t lineOf(Position position) const;
+
+    std::vector<uint32_t> mLineStarts;
+};
+
+}  // namespace PArL::core
@@ -0,0 +1,113 @@
+// parl
+#include <parl/Core.hpp>
+#include <parl/Stack.hpp>
+
+// std
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+
+// unix
+#include <pthread.h>
+
+namespace PArL::core {
+
+namespace {
+
+// the lowest address a thread may use before it is in the
+// red zone, found the first time the thread asks
+thread_local uintptr_t tStackLimit = 0;
+
+uintptr_t findStackLimit() {
+    void *address = nullptr;
+    size_t size = 0;
+
+#if defined(__APPLE__)
+    pthread_t self = pthread_self();
+
+    // the address given is the top of the stack
+    size = pthread_get_stacksize_np(self);
+    address = static_cast<char *>(
+                  pthread_get_stackaddr_np(self)
+              ) -
+              size;
+#else
+    pthread_attr_t attributes;
+
+    // without its bounds the stack is never thought low
+    if (pthread_getattr_np(pthread_self(), &attributes) != 0) {
+        return 1;
+    }
+
+    pthread_attr_getstack(&attributes, &address, &size);
+    pthread_attr_destroy(&attributes);
+#endif
+
+    return reinterpret_cast<uintptr_t>(address) +
+           STACK_RED_ZONE;
+}
+
+struct Segment {
+    std::function<void()> const &task;
+    std::exception_ptr exception{};
+};
+
+void *runSegment(void *argument) {
+    auto *segment = static_cast<Segment *>(argument);
+
+    try {
+        segment->task();
+    } catch (...) {
+        segment->exception = std::current_exception();
+    }
+
+    return nullptr;
+}
+
+}  // namespace
+
+bool isStackLow() {
+    if (tStackLimit == 0) {
+        tStackLimit = findStackLimit();
+    }
+
+    // the stack grows down
+    char marker;
+
+    return reinterpret_cast<uintptr_t>(&marker) < tStackLimit;
+}
+
+void onNewStack(std::function<void()> const &task) {
+    Segment segment{task};
+    pthread_attr_t attributes;
+    pthread_t thread;
+
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, STACK_SEGMENT_SIZE);
+
+    int error = pthread_create(
+        &thread,
+        &attributes,
+        runSegment,
+        &segment
+    );
+
+    pthread_attr_destroy(&attributes);
+
+    // the stack the task would have to run on is already in
+    // the red zone, so it cannot be carried on
+    if (error != 0) {
+        core::abort("out of stack segments");
+
+        // a release build reports nothing, but still stops
+        std::abort();
+    }
+
+    pthread_join(thread, nullptr);
+
+    if (segment.exception) {
+        std::rethrow_exception(segment.exception);
+    }
+}
+
+}  // namespace PArL::core
@@ -0,0 +1,65 @@
+#pragma once
+
+// std
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// definitions
+#define STACK_RED_ZONE (256 * 1024)
+#define STACK_SEGMENT_SIZE (16 * 1024 * 1024)
+
+namespace PArL::core {
+
+// NOTE: the parser and the visitors recurse once per level
+// of nesting, so a deep enough program would overflow the
+// native stack. Each place the recursion goes through checks
+// how much of the stack is left, and once it is down to the
+// red zone the rest of the recursion carries on in a fresh
+// segment, on a thread of its own, while the caller waits.
+// No thread ever uses more than its own stack. A segment is
+// a thread which lives until the recursion returns out of
+// it, so programs do not nest arbitrarily deep: every
+// STACK_SEGMENT_SIZE of stack costs one live thread, and
+// the depth is bounded by how many threads the process may
+// have. Past that the compiler aborts rather than overflow.
+
+[[nodiscard]] bool isStackLow();
+
+// runs the task on a new stack segment and waits for it,
+// any exception it throws is rethrown in the caller
+void onNewStack(std::function<void()> const& task);
+
+// the part of ensureStack which is rarely taken, kept out of
+// line so the frame of every call which does not take it
+// stays small, as there may be one per level of nesting
+template <typename F>
+[[gnu::noinline]] decltype(auto) onNewStackWith(
+    F&& function
+) {
+    using Result = std::invoke_result_t<F>;
+
+    if constexpr (std::is_void_v<Result>) {
+        onNewStack(function);
+    } else {
+        std::optional<Result> result{};
+
+        onNewStack([&] {
+            result.emplace(function());
+        });
+
+        return Result{std::move(*result)};
+    }
+}
+
+template <typename F>
+decltype(auto) ensureStack(F&& function) {
+    if (!isStackLow()) {
+        return function();
+    }
+
+    return onNewStackWith(std::forward<F>(function));
+}
+
+}  // namespace PArL::core
@@ -0,0 +1,171 @@
+#pragma once
+
+// parl
+#include <parl/AST.hpp>
+#include <parl/Core.hpp>
+#include <parl/Stack.hpp>
+
+namespace PArL::core {
+
+// NOTE: a static visitor switches on the kind of a node and
+// calls the visit of the pass for its type directly, rather
+// than through accept and then a virtual visit, so the call
+// is bound at compile time and may be inlined. A pass
+// derives from StaticVisitor<Pass, Result>, where Result is
+// what its visits return, and only defines the visits it
+// needs. Overload resolution picks the most specific one it
+// has, e.g. visit(Expr*) for any expression without a visit
+// of its own, and the visit(Node*) below for anything else,
+// if the pass brings it into scope.
+
+template <typename Pass, typename Result = void>
+class StaticVisitor {
+   public:
+    Result dispatch(Node* node) {
+        return ensureStack([&]() -> Result {
+            return dispatchKind(node);
+        });
+    }
+
+    Result visit(Node*) {
+        return Result();
+    }
+
+   private:
+    Result dispatchKind(Node* node) {
+        auto* pass = static_cast<Pass*>(this);
+
+        switch (node->kind) {
+            case NodeKind::TYPE:
+                return pass->visit(
+                    static_cast<Type*>(node)
+                );
+            case NodeKind::PAD_WIDTH:
+                return pass->visit(
+                    static_cast<PadWidth*>(node)
+                );
+            case NodeKind::PAD_HEIGHT:
+                return pass->visit(
+                    static_cast<PadHeight*>(node)
+                );
+            case NodeKind::PAD_READ:
+                return pass->visit(
+                    static_cast<PadRead*>(node)
+                );
+            case NodeKind::PAD_RANDOM_INT:
+                return pass->visit(
+                    static_cast<PadRandomInt*>(node)
+                );
+            case NodeKind::BOOLEAN_LITERAL:
+                return pass->visit(
+                    static_cast<BooleanLiteral*>(node)
+                );
+            case NodeKind::INTEGER_LITERAL:
+                return pass->visit(
+                    static_cast<IntegerLiteral*>(node)
+                );
+            case NodeKind::FLOAT_LITERAL:
+                return pass->visit(
+                    static_cast<FloatLiteral*>(node)
+                );
+            case NodeKind::COLOR_LITERAL:
+                return pass->visit(
+                    static_cast<ColorLiteral*>(node)
+                );
+            case NodeKind::ARRAY_LITERAL:
+                return pass->visit(
+                    static_cast<ArrayLiteral*>(node)
+                );
+            case NodeKind::VARIABLE:
+                return pass->visit(
+                    static_cast<Variable*>(node)
+                );
+            case NodeKind::ARRAY_ACCESS:
+                return pass->visit(
+                    static_cast<ArrayAccess*>(node)
+                );
+            case NodeKind::FUNCTION_CALL:
+                return pass->visit(
+                    static_cast<FunctionCall*>(node)
+                );
+            case NodeKind::SUB_EXPR:
+                return pass->visit(
+                    static_cast<SubExpr*>(node)
+                );
+            case NodeKind::BINARY:
+                return pass->visit(
+                    static_cast<Binary*>(node)
+                );
+            case NodeKind::UNARY:
+                return pass->visit(
+                    static_cast<Unary*>(node)
+                );
+            case NodeKind::ASSIGNMENT:
+                return pass->visit(
+                    static_cast<Assignment*>(node)
+                );
+            case NodeKind::VARIABLE_DECL:
+                return pass->visit(
+                    static_cast<VariableDecl*>(node)
+                );
+            case NodeKind::PRINT:
+                return pass->visit(
+                    static_cast<PrintStmt*>(node)
+                );
+            case NodeKind::DELAY:
+                return pass->visit(
+                    static_cast<DelayStmt*>(node)
+                );
+            case NodeKind::WRITE_BOX:
+                return pass->visit(
+                    static_cast<WriteBoxStmt*>(node)
+                );
+            case NodeKind::WRITE:
+                return pass->visit(
+                    static_cast<WriteStmt*>(node)
+                );
+            case NodeKind::CLEAR:
+                return pass->visit(
+                    static_cast<ClearStmt*>(node)
+                );
+            case NodeKind::BLOCK:
+                return pass->visit(
+                    static_cast<Block*>(node)
+                );
+            case NodeKind::FORMAL_PARAM:
+                return pass->visit(
+                    static_cast<FormalParam*>(node)
+                );
+            case NodeKind::FUNCTION_DECL:
+                return pass->visit(
+                    static_cast<FunctionDecl*>(node)
+                );
+            case NodeKind::IF:
+                return pass->visit(
+                    static_cast<IfStmt*>(node)
+                );
+            case NodeKind::FOR:
+                return pass->visit(
+                    static_cast<ForStmt*>(node)
+                );
+            case NodeKind::WHILE:
+                return pass->visit(
+                    static_cast<WhileStmt*>(node)
+                );
+            case NodeKind::RETURN:
+                return pass->visit(
+                    static_cast<ReturnStmt*>(node)
+                );
+            case NodeKind::PROGRAM:
+                return pass->visit(
+                    static_cast<Program*>(node)
+                );
+        }
+
+        abort("unreachable");
+
+        return Result();
+    }
+};
+
+}  // namespace PArL::core
@@ -5,59 +5,48 @@
 #include <parl/Token.hpp>
 
 // std
-#include <unordered_map>
+#include <type_traits>
 
 namespace PArL {
 
-static const std::unordered_map<std::string, Token::Type>
-    keywords{
-        {"float", Token::Type::FLOAT_TYPE},
-        {"int", Token::Type::INTEGER_TYPE},
-        {"bool", Token::Type::BOOL_TYPE},
-        {"color", Token::Type::COLOR_TYPE},
-        {"and", Token::Type::AND},
-        {"or", Token::Type::OR},
-        {"not", Token::Type::NOT},
-        {"as", Token::Type::AS},
-        {"let", Token::Type::LET},
-        {"return", Token::Type::RETURN},
-        {"if", Token::Type::IF},
-        {"else", Token::Type::ELSE},
-        {"for", Token::Type::FOR},
-        {"while", Token::Type::WHILE},
-        {"fun", Token::Type::FUN},
-    };
-
-static const std::unordered_map<std::string, Token::Type>
-    keywordLiterals{
-        {"true", Token::Type::BOOL},
-        {"false", Token::Type::BOOL},
-    };
+static_assert(
+    std::is_trivially_copyable_v<Token>,
+    "tokens are passed around by value"
+);
 
 Token::Token()
-    : mPosition({0, 0}), mType(Type::END_OF_FILE) {
+    : mPosition(0), mType(Type::END_OF_FILE) {
 }
 
 Token::Token(
-    int line,
-    int column,
-    std::string lexeme,
+    core::Position position,
+    std::string_view lexeme,
     Type type
 )
-    : mPosition({line, column}),
-      mLexeme(std::move(lexeme)),
+    : mPosition(position),
+      mLexeme(lexeme),
       mType(type) {
     if (isContainerType())
         specialise();
 }
 
-Token::Token(const Token& other) = default;
+Token::Token(
+    core::Position position,
+    std::string_view lexeme,
+    Type type,
+    Value value
+)
+    : mPosition(position),
+      mLexeme(lexeme),
+      mType(type),
+      mValue(value) {
+}
 
 core::Position Token::getPosition() const {
     return mPosition;
 }
 
-std::string Token::getLexeme() const {
+std::string_view Token::getLexeme() const {
     return mLexeme;
 }
 
@@ -65,6 +54,10 @@ Token::Type Token::getType() const {
     return mType;
 }
 
+std::optional<Value> Token::getValue() const {
+    return mValue;
+}
+
 std::string Token::toString() const {
     switch (mType) {
         case Type::LEFT_BRACK:
@@ -185,18 +178,10 @@ bool Token::isContainerType() const {
     }
 }
 
-void Token::specialise() {
-    if (mType == Type::IDENTIFIER) {
-        if (keywords.count(mLexeme) > 0) {
-            mType = keywords.at(mLexeme);
-            return;
-        }
-
-        if (keywordLiterals.count(mLexeme) > 0) {
-            mType = keywordLiterals.at(mLexeme);
-        }
-    }
+// NOTE: keywords are told apart from identifiers by the
+// lexer, so an identifier never needs to be looked up here
 
+void Token::specialise() {
     switch (mType) {
         case Type::FLOAT:
             mValue = create<float>(mLexeme);
@@ -214,7 +199,7 @@ void Token::specialise() {
             mValue = create<core::Builtin>(mLexeme);
             break;
         case Type::IDENTIFIER:
-            mValue = create<std::string>(mLexeme);
+            // identifiers are read straight from the lexeme
             break;
         default:
             core::abort("unreachable");
@@ -5,13 +5,21 @@
 #include <parl/Value.hpp>
 
 // std
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <string_view>
 
 namespace PArL {
 
+// NOTE: a token is a small trivially copyable value, the
+// lexeme is a view into the source held by the lexer and
+// literals are decoded once when the token is created, so
+// the source must outlive any token produced from it
+
 class Token {
    public:
-    enum class Type {
+    enum class Type : uint8_t {
         // one or two character tokens
         LEFT_BRACK,
         RIGHT_BRACK,
@@ -71,17 +79,24 @@ class Token {
     Token();
 
     Token(
-        int line,
-        int column,
-        std::string lexeme,
+        core::Position position,
+        std::string_view lexeme,
         Type type
     );
 
-    Token(const Token& other);
+    // for tokens whose literal is already known, e.g. when
+    // the lexer recognised a boolean or a builtin
+    Token(
+        core::Position position,
+        std::string_view lexeme,
+        Type type,
+        Value value
+    );
 
     [[nodiscard]] core::Position getPosition() const;
-    [[nodiscard]] std::string getLexeme() const;
+    [[nodiscard]] std::string_view getLexeme() const;
     [[nodiscard]] Type getType() const;
+    [[nodiscard]] std::optional<Value> getValue() const;
 
     template <typename T>
     std::optional<T> asOpt() const {
@@ -100,7 +115,7 @@ class Token {
     void specialise();
 
     core::Position mPosition;
-    std::string mLexeme;
+    std::string_view mLexeme;
     Type mType;
     std::optional<Value> mValue;
 };
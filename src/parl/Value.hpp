@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 
@@ -13,7 +14,7 @@
 
 namespace PArL {
 
-static const std::unordered_map<std::string, core::Builtin>
+static const std::unordered_map<std::string_view, core::Builtin>
     builtins{
         {"__width", core::Builtin::WIDTH},
         {"__height", core::Builtin::HEIGHT},
@@ -43,63 +44,62 @@ struct Value {
         return std::get<T>(data);
     }
 
+    // NOTE: only trivially copyable alternatives are allowed
+    // so that a token stays trivially copyable
     std::variant<
         float,
         int,
         core::Color,
         bool,
         core::Builtin,
-        std::string>
+        core::Atom>
         data;
 };
 
 template <typename T>
-static Value create(const std::string&) {
+static Value create(std::string_view) {
     core::abort("unimplemented");
 }
 
 template <>
-Value create<bool>(const std::string& lexeme) {
+Value create<bool>(std::string_view lexeme) {
     return {lexeme == "true"};
 }
 
+static inline uint8_t hexByte(std::string_view digits) {
+    return static_cast<uint8_t>(
+        std::stoi(std::string{digits}, nullptr, 16)
+    );
+}
+
 template <>
-Value create<core::Color>(const std::string& lexeme) {
+Value create<core::Color>(std::string_view lexeme) {
     return {core::Color{
-        static_cast<uint8_t>(
-            stoi(lexeme.substr(1, 2), nullptr, 16)
-        ),
-        static_cast<uint8_t>(
-            stoi(lexeme.substr(3, 2), nullptr, 16)
-        ),
-        static_cast<uint8_t>(
-            stoi(lexeme.substr(5, 2), nullptr, 16)
-        )
+        hexByte(lexeme.substr(1, 2)),
+        hexByte(lexeme.substr(3, 2)),
+        hexByte(lexeme.substr(5, 2))
     }};
 }
 
 template <>
-Value create<float>(const std::string& lexeme) {
-    return {std::stof(lexeme)};
+Value create<float>(std::string_view lexeme) {
+    return {std::stof(std::string{lexeme})};
 }
 
 template <>
-Value create<int>(const std::string& lexeme) {
-    return {std::stoi(lexeme)};
+Value create<int>(std::string_view lexeme) {
+    return {std::stoi(std::string{lexeme})};
 }
 
 template <>
-Value create<core::Builtin>(const std::string& lexeme) {
+Value create<core::Builtin>(std::string_view lexeme) {
     if (builtins.count(lexeme) <= 0) {
-        throw UndefinedBuiltin(lexeme + " is an undefined builtin");
+        throw UndefinedBuiltin(
+            std::string{lexeme} + " is an undefined builtin"
+        );
     }
 
     return {builtins.at(lexeme)};
 }
 
-template <>
-Value create<std::string>(const std::string& lexeme) {
-    return {lexeme};
-}
-
 }  // namespace PArL
@@ -0,0 +1,478 @@
+// parl
+#include <parl/Stack.hpp>
+#include <parser/FlatEmitter.hpp>
+
+// std
+#include <utility>
+
+namespace PArL {
+
+using Kind = core::FlatTree::Kind;
+
+namespace {
+
+// copies the nodes reachable from the root into a new tree
+// in the order a parser makes them, children first, a cast
+// right after the node it is on, and every run of children
+// added along with the node it belongs to
+class Renumbering {
+   public:
+    explicit Renumbering(core::FlatTree const &from)
+        : mFrom(from), mIds(from.size(), NO_NODE) {
+    }
+
+    core::FlatTree run() {
+        mTo.setRoot(copy(mFrom.root()));
+
+        return std::move(mTo);
+    }
+
+    // the id each node was given, or NO_NODE if it could
+    // not be reached
+    [[nodiscard]] core::NodeId id(core::NodeId old) const {
+        return mIds[old];
+    }
+
+   private:
+    core::NodeId copy(core::NodeId id) {
+        if (id == NO_NODE) {
+            return NO_NODE;
+        }
+
+        return core::ensureStack([&] {
+            return copyNode(id);
+        });
+    }
+
+    uint32_t copyList(uint32_t start, uint32_t length) {
+        std::vector<core::NodeId> ids{};
+
+        ids.reserve(length);
+
+        for (core::NodeId id : mFrom.list(start, length)) {
+            ids.push_back(copy(id));
+        }
+
+        return mTo.addList(ids);
+    }
+
+    core::NodeId copyNode(core::NodeId id) {
+        core::FlatTree::Node node = mFrom.node(id);
+
+        // which operands are children, and which start a
+        // run, depends on the kind, see FlatAST.hpp
+        switch (node.kind) {
+            case Kind::PAD_READ:
+            case Kind::BINARY:
+            case Kind::WHILE:
+                node.a = copy(node.a);
+                node.b = copy(node.b);
+                break;
+            case Kind::PAD_RANDOM_INT:
+            case Kind::SUB_EXPR:
+            case Kind::UNARY:
+            case Kind::PRINT:
+            case Kind::DELAY:
+            case Kind::CLEAR:
+            case Kind::RETURN:
+                node.a = copy(node.a);
+                break;
+            case Kind::TYPE:
+            case Kind::ARRAY_ACCESS:
+            case Kind::FORMAL_PARAM:
+                node.b = copy(node.b);
+                break;
+            case Kind::ASSIGNMENT:
+            case Kind::VARIABLE_DECL:
+                node.b = copy(node.b);
+                node.c = copy(node.c);
+                break;
+            case Kind::IF:
+                node.a = copy(node.a);
+                node.b = copy(node.b);
+                node.c = copy(node.c);
+                break;
+            case Kind::ARRAY_LITERAL:
+            case Kind::WRITE_BOX:
+            case Kind::WRITE:
+            case Kind::BLOCK:
+            case Kind::FOR:
+            case Kind::PROGRAM:
+                node.a = copyList(node.a, node.b);
+                break;
+            case Kind::FUNCTION_CALL:
+                node.b = copyList(node.b, node.c);
+                break;
+            case Kind::FUNCTION_DECL:
+                // the type and the block follow the
+                // parameters
+                node.b = copyList(node.b, node.c + 2);
+                break;
+            default:
+                // literals and variables have no children
+                break;
+        }
+
+        core::NodeId cast = node.cast;
+
+        node.cast = NO_NODE;
+        mIds[id] = mTo.add(node);
+
+        if (cast != NO_NODE) {
+            mTo.setCast(mIds[id], copy(cast));
+        }
+
+        return mIds[id];
+    }
+
+    core::FlatTree const &mFrom;
+    core::FlatTree mTo{};
+    std::vector<core::NodeId> mIds;
+};
+
+}  // namespace
+
+void FlatEmitter::emit(core::Type *type) {
+    add(
+        type,
+        Kind::TYPE,
+        type->isArray,
+        idOf(type->size),
+        0,
+        static_cast<uint8_t>(type->base)
+    );
+}
+
+void FlatEmitter::emit(core::PadWidth *expr) {
+    add(expr, Kind::PAD_WIDTH);
+}
+
+void FlatEmitter::emit(core::PadHeight *expr) {
+    add(expr, Kind::PAD_HEIGHT);
+}
+
+void FlatEmitter::emit(core::PadRead *expr) {
+    add(
+        expr,
+        Kind::PAD_READ,
+        expr->x->flatId,
+        expr->y->flatId
+    );
+}
+
+void FlatEmitter::emit(core::PadRandomInt *expr) {
+    add(expr, Kind::PAD_RANDOM_INT, expr->max->flatId);
+}
+
+void FlatEmitter::emit(core::BooleanLiteral *literal) {
+    add(literal, Kind::BOOLEAN_LITERAL, literal->value);
+}
+
+void FlatEmitter::emit(core::IntegerLiteral *literal) {
+    add(
+        literal,
+        Kind::INTEGER_LITERAL,
+        core::FlatTree::fromInt(literal->value)
+    );
+}
+
+void FlatEmitter::emit(core::FloatLiteral *literal) {
+    add(
+        literal,
+        Kind::FLOAT_LITERAL,
+        core::FlatTree::fromFloat(literal->value)
+    );
+}
+
+void FlatEmitter::emit(core::ColorLiteral *literal) {
+    add(
+        literal,
+        Kind::COLOR_LITERAL,
+        core::FlatTree::fromColor(literal->value)
+    );
+}
+
+void FlatEmitter::emit(core::ArrayLiteral *literal) {
+    uint32_t start = addList(literal->exprs);
+
+    add(
+        literal,
+        Kind::ARRAY_LITERAL,
+        start,
+        literal->exprs.size()
+    );
+}
+
+void FlatEmitter::emit(core::Variable *expr) {
+    add(expr, Kind::VARIABLE, expr->identifier.id());
+}
+
+void FlatEmitter::emit(core::ArrayAccess *expr) {
+    add(
+        expr,
+        Kind::ARRAY_ACCESS,
+        expr->identifier.id(),
+        expr->index->flatId
+    );
+}
+
+void FlatEmitter::emit(core::FunctionCall *expr) {
+    uint32_t start = addList(expr->params);
+
+    add(
+        expr,
+        Kind::FUNCTION_CALL,
+        expr->identifier.id(),
+        start,
+        expr->params.size()
+    );
+}
+
+void FlatEmitter::emit(core::SubExpr *expr) {
+    add(expr, Kind::SUB_EXPR, expr->subExpr->flatId);
+}
+
+void FlatEmitter::emit(core::Binary *expr) {
+    add(
+        expr,
+        Kind::BINARY,
+        expr->left->flatId,
+        expr->right->flatId,
+        0,
+        static_cast<uint8_t>(expr->op)
+    );
+}
+
+void FlatEmitter::emit(core::Unary *expr) {
+    add(
+        expr,
+        Kind::UNARY,
+        expr->expr->flatId,
+        0,
+        0,
+        static_cast<uint8_t>(expr->op)
+    );
+}
+
+void FlatEmitter::emit(core::Assignment *stmt) {
+    add(
+        stmt,
+        Kind::ASSIGNMENT,
+        stmt->identifier.id(),
+        idOf(stmt->index),
+        stmt->expr->flatId
+    );
+}
+
+void FlatEmitter::emit(core::VariableDecl *stmt) {
+    add(
+        stmt,
+        Kind::VARIABLE_DECL,
+        stmt->identifier.id(),
+        stmt->type->flatId,
+        stmt->expr->flatId
+    );
+}
+
+void FlatEmitter::emit(core::PrintStmt *stmt) {
+    add(stmt, Kind::PRINT, stmt->expr->flatId);
+}
+
+void FlatEmitter::emit(core::DelayStmt *stmt) {
+    add(stmt, Kind::DELAY, stmt->expr->flatId);
+}
+
+void FlatEmitter::emit(core::WriteBoxStmt *stmt) {
+    uint32_t start = addList(
+        std::vector<core::Expr *>{
+            stmt->x,
+            stmt->y,
+            stmt->w,
+            stmt->h,
+            stmt->color
+        }
+    );
+
+    add(stmt, Kind::WRITE_BOX, start, 5);
+}
+
+void FlatEmitter::emit(core::WriteStmt *stmt) {
+    uint32_t start = addList(
+        std::vector<core::Expr *>{stmt->x, stmt->y, stmt->color}
+    );
+
+    add(stmt, Kind::WRITE, start, 3);
+}
+
+void FlatEmitter::emit(core::ClearStmt *stmt) {
+    add(stmt, Kind::CLEAR, stmt->color->flatId);
+}
+
+void FlatEmitter::emit(core::Block *block) {
+    uint32_t start = addList(block->stmts);
+
+    add(block, Kind::BLOCK, start, block->stmts.size());
+}
+
+void FlatEmitter::emit(core::FormalParam *param) {
+    add(
+        param,
+        Kind::FORMAL_PARAM,
+        param->identifier.id(),
+        param->type->flatId
+    );
+}
+
+void FlatEmitter::emit(core::FunctionDecl *stmt) {
+    std::vector<core::NodeId> ids{};
+
+    for (auto *param : stmt->params) {
+        ids.push_back(param->flatId);
+    }
+
+    // a body left for later is set by emitBody
+    ids.push_back(stmt->type->flatId);
+    ids.push_back(idOf(stmt->block));
+
+    add(
+        stmt,
+        Kind::FUNCTION_DECL,
+        stmt->identifier.id(),
+        mTree->addList(ids),
+        stmt->params.size()
+    );
+}
+
+void FlatEmitter::emit(core::IfStmt *stmt) {
+    add(
+        stmt,
+        Kind::IF,
+        stmt->cond->flatId,
+        stmt->thenBlock->flatId,
+        idOf(stmt->elseBlock)
+    );
+}
+
+void FlatEmitter::emit(core::ForStmt *stmt) {
+    std::vector<core::NodeId> ids{
+        idOf(stmt->decl),
+        stmt->cond->flatId,
+        idOf(stmt->assignment),
+        stmt->block->flatId
+    };
+
+    add(stmt, Kind::FOR, mTree->addList(ids), 4);
+}
+
+void FlatEmitter::emit(core::WhileStmt *stmt) {
+    add(
+        stmt,
+        Kind::WHILE,
+        stmt->cond->flatId,
+        stmt->block->flatId
+    );
+}
+
+void FlatEmitter::emit(core::ReturnStmt *stmt) {
+    add(stmt, Kind::RETURN, stmt->expr->flatId);
+}
+
+void FlatEmitter::emit(core::Program *prog) {
+    uint32_t start = addList(prog->stmts);
+
+    add(prog, Kind::PROGRAM, start, prog->stmts.size());
+}
+
+void FlatEmitter::emitCast(core::Expr *expr) {
+    mTree->setCast(expr->flatId, (*expr->type)->flatId);
+}
+
+void FlatEmitter::emitBody(core::FunctionDecl *stmt) {
+    core::FlatTree::Node const &flat =
+        mTree->node(stmt->flatId);
+
+    // the block follows the parameters and the type
+    mTree->setListEntry(
+        flat.b + flat.c + 1,
+        stmt->block->flatId
+    );
+}
+
+void FlatEmitter::adopt(FlatEmitter &other) {
+    core::NodeId offset = mTree->append(*other.mTree);
+
+    for (core::Node *node : other.mNodes) {
+        node->flatId += offset;
+    }
+
+    mNodes.insert(
+        mNodes.end(),
+        other.mNodes.begin(),
+        other.mNodes.end()
+    );
+
+    other.reset();
+}
+
+void FlatEmitter::renumber(core::Program *prog) {
+    mTree->setRoot(prog->flatId);
+
+    Renumbering renumbering{*mTree};
+    core::FlatTree tree = renumbering.run();
+    std::vector<core::Node *> nodes(tree.size(), nullptr);
+
+    for (core::NodeId id = 0; id < mNodes.size(); id++) {
+        core::NodeId newId = renumbering.id(id);
+
+        // what was left of a body which did not parse
+        if (newId == NO_NODE) {
+            mNodes[id]->flatId = NO_NODE;
+
+            continue;
+        }
+
+        mNodes[id]->flatId = newId;
+        nodes[newId] = mNodes[id];
+    }
+
+    *mTree = std::move(tree);
+    mNodes = std::move(nodes);
+}
+
+void FlatEmitter::reset() {
+    mOwned = std::make_unique<core::FlatTree>();
+    mTree = mOwned.get();
+    mNodes.clear();
+}
+
+std::unique_ptr<core::FlatTree> FlatEmitter::take(
+    core::Program *prog
+) {
+    mTree->setRoot(prog->flatId);
+
+    return std::move(mOwned);
+}
+
+void FlatEmitter::add(
+    core::Node *node,
+    core::FlatTree::Kind kind,
+    uint32_t a,
+    uint32_t b,
+    uint32_t c,
+    uint8_t tag
+) {
+    core::FlatTree::Node flat{kind, tag, node->position.offset()};
+
+    flat.a = a;
+    flat.b = b;
+    flat.c = c;
+
+    node->flatId = mTree->add(flat);
+    mNodes.push_back(node);
+}
+
+core::NodeId FlatEmitter::idOf(core::Node *node) {
+    return node == nullptr ? NO_NODE : node->flatId;
+}
+
+}  // namespace PArL
@@ -0,0 +1,109 @@
+#pragma once
+
+// std
+#include <memory>
+#include <vector>
+
+// parl
+#include <parl/AST.hpp>
+#include <parl/FlatAST.hpp>
+
+namespace PArL {
+
+// NOTE: the parser hands every node it makes to a flat
+// emitter, which adds it to a flat tree and records where on
+// the node. A parser makes children before their parents, so
+// the node array is in post-order, and a pass over it in
+// order sees every subtree before the node it belongs to.
+// The exceptions are a cast, which is parsed after the
+// expression, and a body a lazy parser left for later, which
+// are set on their node once they are made.
+//
+// Bodies parsed later, or by workers, end up after the rest
+// of the program, renumber puts the nodes back in the order
+// a parser which left nothing for later would have made
+// them, so the tree does not depend on how it was parsed.
+
+class FlatEmitter {
+   public:
+    void emit(core::Type *);
+    void emit(core::PadWidth *);
+    void emit(core::PadHeight *);
+    void emit(core::PadRead *);
+    void emit(core::PadRandomInt *);
+    void emit(core::BooleanLiteral *);
+    void emit(core::IntegerLiteral *);
+    void emit(core::FloatLiteral *);
+    void emit(core::ColorLiteral *);
+    void emit(core::ArrayLiteral *);
+    void emit(core::Variable *);
+    void emit(core::ArrayAccess *);
+    void emit(core::FunctionCall *);
+    void emit(core::SubExpr *);
+    void emit(core::Binary *);
+    void emit(core::Unary *);
+    void emit(core::Assignment *);
+    void emit(core::VariableDecl *);
+    void emit(core::PrintStmt *);
+    void emit(core::DelayStmt *);
+    void emit(core::WriteBoxStmt *);
+    void emit(core::WriteStmt *);
+    void emit(core::ClearStmt *);
+    void emit(core::Block *);
+    void emit(core::FormalParam *);
+    void emit(core::FunctionDecl *);
+    void emit(core::IfStmt *);
+    void emit(core::ForStmt *);
+    void emit(core::WhileStmt *);
+    void emit(core::ReturnStmt *);
+    void emit(core::Program *);
+
+    void emitCast(core::Expr *);
+    void emitBody(core::FunctionDecl *);
+
+    // takes over the nodes of another emitter, e.g. a
+    // worker parser's, and gives them their ids here
+    void adopt(FlatEmitter &other);
+    // see above, the program is the root
+    void renumber(core::Program *);
+
+    void reset();
+
+    // the root is the program. Bodies parsed later are
+    // still added to the tree, so it has to outlive them
+    std::unique_ptr<core::FlatTree> take(core::Program *);
+
+   private:
+    void add(
+        core::Node *,
+        core::FlatTree::Kind,
+        uint32_t a = 0,
+        uint32_t b = 0,
+        uint32_t c = 0,
+        uint8_t tag = 0
+    );
+
+    template <typename T>
+    uint32_t addList(std::vector<T *> const &nodes) {
+        std::vector<core::NodeId> ids{};
+
+        ids.reserve(nodes.size());
+
+        for (auto *node : nodes) {
+            ids.push_back(node->flatId);
+        }
+
+        return mTree->addList(ids);
+    }
+
+    static core::NodeId idOf(core::Node *);
+
+    std::unique_ptr<core::FlatTree> mOwned{
+        std::make_unique<core::FlatTree>()
+    };
+    core::FlatTree *mTree{mOwned.get()};
+    // the node each flat node was emitted for
+    std::vector<core::Node *> mNodes{};
+};
+
+}  // namespace PArL
@@ -0,0 +1,296 @@
+// parl
+#include <parl/Stack.hpp>
+#include <parser/FlatPrinter.hpp>
+
+namespace PArL {
+
+using Kind = core::FlatTree::Kind;
+
+FlatPrinter::FlatPrinter(
+    core::FlatTree const &tree,
+    core::Interner const &interner
+)
+    : mTree(tree), mInterner(interner) {
+}
+
+void FlatPrinter::print() {
+    mTabCount = 0;
+
+    print(mTree.root());
+}
+
+void FlatPrinter::print(core::NodeId id) {
+    core::ensureStack([&] {
+        printNode(id);
+    });
+}
+
+void FlatPrinter::printNode(core::NodeId id) {
+    core::FlatTree::Node const &node = mTree.node(id);
+
+    switch (node.kind) {
+        case Kind::TYPE: {
+            std::string primitive =
+                baseToString(mTree.base(id));
+
+            if (node.a == 0) {
+                print_with_tabs("{}", primitive);
+            } else if (node.b != NO_NODE) {
+                print_with_tabs(
+                    "{}[{}]",
+                    primitive,
+                    mTree.intValue(node.b)
+                );
+            } else {
+                print_with_tabs("{}[]", primitive);
+            }
+
+            return;
+        }
+        case Kind::PAD_WIDTH:
+            print_with_tabs("__width");
+            break;
+        case Kind::PAD_HEIGHT:
+            print_with_tabs("__height");
+            break;
+        case Kind::PAD_READ:
+            print_with_tabs("__read =>");
+            mTabCount++;
+            print(node.a);
+            print(node.b);
+            mTabCount--;
+            break;
+        case Kind::PAD_RANDOM_INT:
+            print_with_tabs("__random_int =>");
+            mTabCount++;
+            print(node.a);
+            mTabCount--;
+            break;
+        case Kind::BOOLEAN_LITERAL:
+            print_with_tabs("bool {}", mTree.boolValue(id));
+            break;
+        case Kind::INTEGER_LITERAL:
+            print_with_tabs("int {}", mTree.intValue(id));
+            break;
+        case Kind::FLOAT_LITERAL:
+            print_with_tabs("float {}", mTree.floatValue(id));
+            break;
+        case Kind::COLOR_LITERAL: {
+            core::Color color = mTree.colorValue(id);
+
+            print_with_tabs(
+                "color #{:x}{:x}{:x}",
+                color.r(),
+                color.g(),
+                color.b()
+            );
+            break;
+        }
+        case Kind::ARRAY_LITERAL:
+            print_with_tabs("[");
+            mTabCount++;
+            printChildren(mTree.children(id));
+            mTabCount--;
+            print_with_tabs("]");
+            break;
+        case Kind::VARIABLE:
+            print_with_tabs(
+                "Variable {}",
+                mInterner.name(mTree.atom(id))
+            );
+            break;
+        case Kind::ARRAY_ACCESS:
+            print_with_tabs(
+                "Array Access {} =>",
+                mInterner.name(mTree.atom(id))
+            );
+            mTabCount++;
+            print(node.b);
+            mTabCount--;
+            break;
+        case Kind::FUNCTION_CALL:
+            print_with_tabs(
+                "Function Call {} =>",
+                mInterner.name(mTree.atom(id))
+            );
+            mTabCount++;
+            printChildren(mTree.list(node.b, node.c));
+            mTabCount--;
+            break;
+        case Kind::SUB_EXPR:
+            // as with the printer visitor, the cast of a
+            // sub expression is not shown
+            print(node.a);
+            return;
+        case Kind::BINARY:
+            print_with_tabs(
+                "Binary Operation {} =>",
+                operationToString(mTree.operation(id))
+            );
+            mTabCount++;
+            print(node.a);
+            print(node.b);
+            mTabCount--;
+            break;
+        case Kind::UNARY:
+            print_with_tabs(
+                "Unary Operation {} =>",
+                operationToString(mTree.operation(id))
+            );
+            mTabCount++;
+            print(node.a);
+            mTabCount--;
+            break;
+        case Kind::ASSIGNMENT:
+            print_with_tabs(
+                "Assign {} =>",
+                mInterner.name(mTree.atom(id))
+            );
+
+            if (node.b != NO_NODE) {
+                mTabCount++;
+                print_with_tabs("[");
+                print(node.b);
+                print_with_tabs("]");
+                mTabCount--;
+            }
+
+            mTabCount++;
+            print(node.c);
+            mTabCount--;
+            return;
+        case Kind::VARIABLE_DECL:
+            print_with_tabs(
+                "let {} : ",
+                mInterner.name(mTree.atom(id))
+            );
+            mTabCount++;
+            print(node.b);
+            print(node.c);
+            mTabCount--;
+            return;
+        case Kind::PRINT:
+            print_with_tabs("__print =>");
+            mTabCount++;
+            print(node.a);
+            mTabCount--;
+            return;
+        case Kind::DELAY:
+            print_with_tabs("__delay =>");
+            mTabCount++;
+            print(node.a);
+            mTabCount--;
+            return;
+        case Kind::WRITE_BOX:
+            print_with_tabs("__write_box =>");
+            mTabCount++;
+            printChildren(mTree.children(id));
+            mTabCount--;
+            return;
+        case Kind::WRITE:
+            print_with_tabs("__write =>");
+            mTabCount++;
+            printChildren(mTree.children(id));
+            mTabCount--;
+            return;
+        case Kind::CLEAR:
+            print_with_tabs("__clear =>");
+            mTabCount++;
+            print(node.a);
+            mTabCount--;
+            return;
+        case Kind::BLOCK:
+            print_with_tabs("{{");
+            mTabCount++;
+            printChildren(mTree.children(id));
+            mTabCount--;
+            print_with_tabs("}}");
+            return;
+        case Kind::FORMAL_PARAM:
+            print_with_tabs(
+                "Formal Param {} =>",
+                mInterner.name(mTree.atom(id))
+            );
+            mTabCount++;
+            print(node.b);
+            mTabCount--;
+            return;
+        case Kind::FUNCTION_DECL:
+            // the parameters are followed by the type and
+            // the block
+            print_with_tabs(
+                "Func Decl {} =>",
+                mInterner.name(mTree.atom(id))
+            );
+            mTabCount++;
+            printChildren(mTree.list(node.b, node.c + 2));
+            mTabCount--;
+            return;
+        case Kind::IF:
+            print_with_tabs("If =>");
+            mTabCount++;
+            print(node.a);
+            print(node.b);
+            mTabCount--;
+
+            if (node.c != NO_NODE) {
+                print_with_tabs("Else =>");
+                mTabCount++;
+                print(node.c);
+                mTabCount--;
+            }
+            return;
+        case Kind::FOR:
+            print_with_tabs("For =>");
+            mTabCount++;
+            printChildren(mTree.children(id));
+            mTabCount--;
+            return;
+        case Kind::WHILE:
+            print_with_tabs("While =>");
+            mTabCount++;
+            print(node.a);
+            print(node.b);
+            mTabCount--;
+            return;
+        case Kind::RETURN:
+            print_with_tabs("Return =>");
+            mTabCount++;
+            print(node.a);
+            mTabCount--;
+            return;
+        case Kind::PROGRAM:
+            print_with_tabs("Program =>");
+            mTabCount++;
+            printChildren(mTree.children(id));
+            mTabCount--;
+            return;
+    }
+
+    // only expressions reach this point
+    printCast(id);
+}
+
+void FlatPrinter::printChildren(
+    core::FlatTree::Children children
+) {
+    for (core::NodeId child : children) {
+        // the optional parts of a for statement
+        if (child != NO_NODE) {
+            print(child);
+        }
+    }
+}
+
+void FlatPrinter::printCast(core::NodeId id) {
+    core::NodeId cast = mTree.node(id).cast;
+
+    if (cast != NO_NODE) {
+        print_with_tabs("as");
+        mTabCount++;
+        print(cast);
+        mTabCount--;
+    }
+}
+
+}  // namespace PArL
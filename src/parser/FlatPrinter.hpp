@@ -0,0 +1,49 @@
+#pragma once
+
+// fmt
+#include <fmt/core.h>
+
+// parl
+#include <parl/FlatAST.hpp>
+#include <parl/Interner.hpp>
+
+namespace PArL {
+
+// NOTE: prints a flat tree in the same format as the
+// PrinterVisitor prints the node hierarchy, by switching on
+// the kind of each node rather than dispatching on its type
+
+class FlatPrinter {
+   public:
+    FlatPrinter(
+        core::FlatTree const &tree,
+        core::Interner const &interner
+    );
+
+    void print();
+
+    template <typename... T>
+    inline void print_with_tabs(
+        fmt::format_string<T...> fmt,
+        T &&...args
+    ) {
+        for (int i = 0; i < mTabCount; i++) {
+            fmt::print("  ");
+        }
+
+        fmt::println(fmt, args...);
+    }
+
+   private:
+    void print(core::NodeId id);
+    void printNode(core::NodeId id);
+    void printChildren(core::FlatTree::Children children);
+    void printCast(core::NodeId id);
+
+    core::FlatTree const &mTree;
+    core::Interner const &mInterner;
+
+    int mTabCount = 0;
+};
+
+}  // namespace PArL
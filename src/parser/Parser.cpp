@@ -3,44 +3,317 @@
 
 // std
 #include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <type_traits>
 #include <utility>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <optional>
 
 // parl
 #include <lexer/Lexer.hpp>
 #include <parl/AST.hpp>
+#include <parl/Stack.hpp>
 #include <parser/Parser.hpp>
 
 namespace PArL {
 
+namespace {
+
+constexpr std::optional<core::Operation> operationFromType(
+    Token::Type type
+) {
+    switch (type) {
+        case Token::Type::PLUS:
+            return {core::Operation::ADD};
+        case Token::Type::AND:
+            return {core::Operation::AND};
+        case Token::Type::SLASH:
+            return {core::Operation::DIV};
+        case Token::Type::EQUAL_EQUAL:
+            return {core::Operation::EQ};
+        case Token::Type::GREATER_EQUAL:
+            return {core::Operation::GE};
+        case Token::Type::GREATER:
+            return {core::Operation::GT};
+        case Token::Type::LESS:
+            return {core::Operation::LT};
+        case Token::Type::LESS_EQUAL:
+            return {core::Operation::LE};
+        case Token::Type::STAR:
+            return {core::Operation::MUL};
+        case Token::Type::BANG_EQUAL:
+            return {core::Operation::NEQ};
+        case Token::Type::NOT:
+            return {core::Operation::NOT};
+        case Token::Type::OR:
+            return {core::Operation::OR};
+        case Token::Type::MINUS:
+            return {core::Operation::SUB};
+        default:
+            return {};
+    }
+}
+
+constexpr int NO_BINDING_POWER = 0;
+constexpr int LOWEST_BINDING_POWER = 1;
+
+// how tightly an operation binds as a binary operator, NOT
+// is only ever unary so it does not bind at all
+constexpr int bindingPower(core::Operation op) {
+    switch (op) {
+        case core::Operation::OR:
+            return 1;
+        case core::Operation::AND:
+            return 2;
+        case core::Operation::EQ:
+        case core::Operation::NEQ:
+            return 3;
+        case core::Operation::LT:
+        case core::Operation::LE:
+        case core::Operation::GT:
+        case core::Operation::GE:
+            return 4;
+        case core::Operation::ADD:
+        case core::Operation::SUB:
+            return 5;
+        case core::Operation::MUL:
+        case core::Operation::DIV:
+            return 6;
+        default:
+            return NO_BINDING_POWER;
+    }
+}
+
+constexpr size_t NO_OF_TOKEN_TYPES =
+    static_cast<size_t>(Token::Type::END_OF_FILE) + 1;
+
+// the binding power of every token type, looked up once per
+// operand while parsing an expression
+constexpr std::array<int, NO_OF_TOKEN_TYPES> BINDING_POWERS =
+    [] {
+        std::array<int, NO_OF_TOKEN_TYPES> powers{};
+
+        for (size_t type = 0; type < NO_OF_TOKEN_TYPES;
+             type++) {
+            std::optional<core::Operation> op =
+                operationFromType(
+                    static_cast<Token::Type>(type)
+                );
+
+            powers[type] =
+                op ? bindingPower(*op) : NO_BINDING_POWER;
+        }
+
+        return powers;
+    }();
+
+}  // namespace
+
 // HACK: this is technically a hack to avoid
 // rewriting the constructors of all the
 // AST nodes to keep track of a position
 template <typename T, typename... Args>
-static inline std::unique_ptr<T>
-make_with_pos(core::Position pos, Args &&...args) {
+T *Parser::make_with_pos(core::Position pos, Args &&...args) {
     static_assert(
         std::is_base_of_v<core::Node, T>,
         "type T does inherit from type Node"
     );
 
-    auto unique_ptr =
-        std::make_unique<T>(std::forward<Args>(args)...);
+    T *node = mNodes->make<T>(std::forward<Args>(args)...);
+
+    node->position = pos;
 
-    unique_ptr->position = pos;
+    mEmitter.emit(node);
 
-    return unique_ptr;
+    return node;
 }
 
 Parser::Parser(Lexer &lexer)
     : mLexer(lexer) {
+    mLexer.setMode(Lexer::Mode::SKIP_TRIVIA);
     initWindow();
 }
 
-void Parser::parse(std::string const &source) {
+Parser::Parser(Lexer &lexer, TokenStream const *stream)
+    : mLexer(lexer),
+      mMode(Mode::TOKEN_STREAM),
+      mDeferErrors(true),
+      mArena(std::make_unique<core::Arena>()),
+      mNodes(mArena.get()),
+      mStream(stream) {
+}
+
+Parser::~Parser() {
+    stopPipeline();
+}
+
+void Parser::setMode(Mode mode) {
+    mMode = mode;
+}
+
+void Parser::setLexerThreads(size_t noOfThreads) {
+    mLexerThreads = noOfThreads;
+}
+
+void Parser::setParserThreads(size_t noOfThreads) {
+    mParserThreads = noOfThreads;
+}
+
+void Parser::setLazyBodies(bool isLazy) {
+    mLazyBodies = isLazy;
+}
+
+void Parser::parseBody(core::FunctionDecl *decl) {
+    if (!decl->deferredBody.has_value()) {
+        return;
+    }
+
+    size_t index = *decl->deferredBody;
+
+    // a function of another parser, or of an earlier parse,
+    // is not this parser's to parse
+    if (index < mDeferredBodies.size() &&
+        mDeferredBodies[index].decl == decl) {
+        parseDeferred(index);
+    }
+}
+
+void Parser::parseBodies() {
+    bool hadDeferred = !mDeferredBodies.empty();
+
+    if (mParserThreads > 1 && mDeferredBodies.size() > 1) {
+        parseDeferredInParallel();
+    } else {
+        for (size_t i = 0; i < mDeferredBodies.size();
+             i++) {
+            parseDeferred(i);
+        }
+
+        mDeferredBodies.clear();
+    }
+
+    // the tree is not renumbered once it has been taken, as
+    // the passes may have read it already
+    if (hadDeferred && !mHasError && mAst != nullptr) {
+        mEmitter.renumber(mAst);
+    }
+
+    printErrors();
+}
+
+// NOTE: the bodies are independent of each other, so each
+// worker takes the next one not yet taken and parses it
+// into its own arena. The parser adopts the arenas and the
+// errors once all are done. Functions declared within a
+// body are parsed with it.
+
+void Parser::parseDeferredInParallel() {
+    size_t noOfBodies = mDeferredBodies.size();
+    size_t noOfThreads = std::min(mParserThreads, noOfBodies);
+
+    std::vector<std::unique_ptr<Parser>> workers{};
+    std::vector<std::thread> threads{};
+    std::atomic<size_t> next{0};
+
+    for (size_t i = 0; i < noOfThreads; i++) {
+        workers.emplace_back(new Parser(mLexer, mStream));
+    }
+
+    for (auto &worker : workers) {
+        Parser *parser = worker.get();
+
+        threads.emplace_back([&, parser] {
+            for (size_t i = next++; i < noOfBodies;
+                 i = next++) {
+                DeferredBody body = mDeferredBodies[i];
+
+                // parsed on its own already
+                if (body.decl == nullptr) {
+                    continue;
+                }
+
+                parser->mCurrent = body.start;
+
+                body.decl->block = parser->block();
+                body.decl->deferredBody.reset();
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (auto &worker : workers) {
+        mNodes->adopt(*worker->mArena);
+        mEmitter.adopt(worker->mEmitter);
+        mHasError = mHasError || worker->mHasError;
+        mErrors.insert(
+            mErrors.end(),
+            worker->mErrors.begin(),
+            worker->mErrors.end()
+        );
+    }
+
+    for (DeferredBody const &body : mDeferredBodies) {
+        if (body.decl != nullptr &&
+            body.decl->block != nullptr) {
+            mEmitter.emitBody(body.decl);
+        }
+    }
+
+    mDeferredBodies.clear();
+}
+
+// the errors of a body are all within its braces, so once
+// sorted they come out as they would have had nothing been
+// left for later
+
+void Parser::printErrors() {
+    std::stable_sort(
+        mErrors.begin(),
+        mErrors.end(),
+        [](auto const &left, auto const &right) {
+            return left.first < right.first;
+        }
+    );
+
+    for (auto const &error : mErrors) {
+        fmt::println(stderr, "{}", error.second);
+    }
+
+    mErrors.clear();
+}
+
+void Parser::parse(std::string_view source) {
+    mLexer.setMode(Lexer::Mode::SKIP_TRIVIA);
     mLexer.addSource(source);
+    mSource = source;
+    reset();
+    mAst = program();
+    stopPipeline();
+}
+
+void Parser::parse(std::istream &stream) {
+    // a token stream views a single source, and the lexer
+    // thread may not share the stream's line map while it
+    // is still being built, so the stream is read in full
+    if (mMode != Mode::WINDOWED) {
+        mStreamSource.assign(
+            std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>()
+        );
+
+        parse(mStreamSource);
+
+        return;
+    }
+
+    mLexer.setMode(Lexer::Mode::SKIP_TRIVIA);
+    mLexer.addStream(stream);
     reset();
     mAst = program();
 }
@@ -51,39 +324,68 @@ bool Parser::hasError() const {
 
 void Parser::reset() {
     mHasError = false;
-    mAst.reset();
+    // only a token stream parser leaves bodies for later
+    mDeferErrors =
+        mLazyBodies && mMode == Mode::TOKEN_STREAM;
+    mErrors.clear();
+    mDeferredBodies.clear();
+    mAst = nullptr;
+    mArena = std::make_unique<core::Arena>();
+    mNodes = mArena.get();
+    mEmitter.reset();
     initWindow();
 }
 
-std::unique_ptr<core::Program> Parser::getAst() {
+core::Tree Parser::getAst() {
+    parseBodies();
+
+    return getLazyAst();
+}
+
+core::Tree Parser::getLazyAst() {
     core::abort_if(
         mHasError,
         "parser could not generate tree due to parsing "
         "error(s)"
     );
 
-    return std::move(mAst);
+    core::abort_if(
+        mArena == nullptr,
+        "parser tree has already been taken"
+    );
+
+    core::Tree tree{
+        std::move(mArena),
+        mAst,
+        mEmitter.take(mAst)
+    };
+
+    mAst = nullptr;
+
+    return tree;
 }
 
-std::unique_ptr<core::Program> Parser::program() {
-    std::vector<std::unique_ptr<core::Stmt>> stmts;
+core::Program *Parser::program() {
+    std::vector<core::Stmt *> stmts;
 
     while (!isAtEnd()) {
-        try {
-            stmts.emplace_back(statement());
-        } catch (SyncParser const &) {
+        core::Stmt *stmt = statement();
+
+        if (stmt == nullptr) {
             synchronize();
+        } else {
+            stmts.emplace_back(stmt);
         }
     }
 
     return make_with_pos<core::Program>(
-        {1, 1},
+        {0},
         std::move(stmts)
     );
 }
 
-std::unique_ptr<core::Stmt> Parser::statement() {
-    Token peekToken = peek();
+core::Stmt *Parser::statement() {
+    Token const &peekToken = peek();
 
     switch (peekToken.getType()) {
         case Token::Type::BUILTIN: {
@@ -92,53 +394,78 @@ std::unique_ptr<core::Stmt> Parser::statement() {
 
             switch (builtinType) {
                 case core::Builtin::PRINT: {
-                    std::unique_ptr<core::PrintStmt> stmt =
+                    core::PrintStmt *stmt =
                         printStatement();
-                    consume(
-                        Token::Type::SEMICOLON,
-                        "expected ';' after __print "
-                        "statement"
-                    );
+
+                    if (stmt == nullptr ||
+                        !consume(
+                            Token::Type::SEMICOLON,
+                            "expected ';' after __print "
+                            "statement"
+                        )) {
+                        return nullptr;
+                    }
+
                     return stmt;
                 }
                 case core::Builtin::DELAY: {
-                    std::unique_ptr<core::DelayStmt> stmt =
+                    core::DelayStmt *stmt =
                         delayStatement();
-                    consume(
-                        Token::Type::SEMICOLON,
-                        "expected ';' after __delay "
-                        "statement"
-                    );
+
+                    if (stmt == nullptr ||
+                        !consume(
+                            Token::Type::SEMICOLON,
+                            "expected ';' after __delay "
+                            "statement"
+                        )) {
+                        return nullptr;
+                    }
+
                     return stmt;
                 }
                 case core::Builtin::WRITE: {
-                    std::unique_ptr<core::WriteStmt> stmt =
+                    core::WriteStmt *stmt =
                         writeStatement();
-                    consume(
-                        Token::Type::SEMICOLON,
-                        "expected ';' after __write "
-                        "statement"
-                    );
+
+                    if (stmt == nullptr ||
+                        !consume(
+                            Token::Type::SEMICOLON,
+                            "expected ';' after __write "
+                            "statement"
+                        )) {
+                        return nullptr;
+                    }
+
                     return stmt;
                 }
                 case core::Builtin::CLEAR: {
-                    std::unique_ptr<core::ClearStmt> stmt =
+                    core::ClearStmt *stmt =
                         clearStatement();
-                    consume(
-                        Token::Type::SEMICOLON,
-                        "expected ';' after __clear "
-                        "statement"
-                    );
+
+                    if (stmt == nullptr ||
+                        !consume(
+                            Token::Type::SEMICOLON,
+                            "expected ';' after __clear "
+                            "statement"
+                        )) {
+                        return nullptr;
+                    }
+
                     return stmt;
                 }
                 case core::Builtin::WRITE_BOX: {
-                    std::unique_ptr<core::WriteBoxStmt>
-                        stmt = writeBoxStatement();
-                    consume(
-                        Token::Type::SEMICOLON,
-                        "expected ';' after "
-                        "__write_box statement"
-                    );
+                    core::WriteBoxStmt *stmt =
+                        writeBoxStatement();
+
+                    if (stmt == nullptr ||
+                        !consume(
+                            Token::Type::SEMICOLON,
+                            "expected ';' after "
+                            "__write_box statement"
+                        )) {
+                        return nullptr;
+                    }
+
                     return stmt;
                 }
                 default:
@@ -148,6 +475,8 @@ std::unique_ptr<core::Stmt> Parser::statement() {
                         "statement",
                         peekToken.toString()
                     );
+
+                    return nullptr;
             }
         } break;
         case Token::Type::LEFT_BRACE:
@@ -161,33 +490,48 @@ std::unique_ptr<core::Stmt> Parser::statement() {
         case Token::Type::FUN:
             return functionDecl();
         case Token::Type::RETURN: {
-            std::unique_ptr<core::ReturnStmt> stmt =
+            core::ReturnStmt *stmt =
                 returnStmt();
-            consume(
-                Token::Type::SEMICOLON,
-                "expected ';' after "
-                "return statement"
-            );
+
+            if (stmt == nullptr ||
+                !consume(
+                    Token::Type::SEMICOLON,
+                    "expected ';' after "
+                    "return statement"
+                )) {
+                return nullptr;
+            }
+
             return stmt;
         }
         case Token::Type::LET: {
-            std::unique_ptr<core::VariableDecl> stmt =
+            core::VariableDecl *stmt =
                 variableDecl();
-            consume(
-                Token::Type::SEMICOLON,
-                "expected ';' after "
-                "variable declaration"
-            );
+
+            if (stmt == nullptr ||
+                !consume(
+                    Token::Type::SEMICOLON,
+                    "expected ';' after "
+                    "variable declaration"
+                )) {
+                return nullptr;
+            }
+
             return stmt;
         }
         case Token::Type::IDENTIFIER: {
-            std::unique_ptr<core::Assignment> stmt =
+            core::Assignment *stmt =
                 assignment();
-            consume(
-                Token::Type::SEMICOLON,
-                "expected ';' after "
-                "assignment"
-            );
+
+            if (stmt == nullptr ||
+                !consume(
+                    Token::Type::SEMICOLON,
+                    "expected ';' after "
+                    "assignment"
+                )) {
+                return nullptr;
+            }
+
             return stmt;
         }
         default:
@@ -196,30 +540,40 @@ std::unique_ptr<core::Stmt> Parser::statement() {
                 "statement start",
                 peekToken.toString()
             );
+
+            return nullptr;
     }
 }
 
-std::unique_ptr<core::Block> Parser::block() {
-    consume(
-        Token::Type::LEFT_BRACE,
-        "expected '{{' at start of block"
-    );
+core::Block *Parser::block() {
+    if (!consume(
+            Token::Type::LEFT_BRACE,
+            "expected '{{' at start of block"
+        )) {
+        return nullptr;
+    }
 
-    std::vector<std::unique_ptr<core::Stmt>> stmts;
+    std::vector<core::Stmt *> stmts;
 
     while (!isAtEnd() &&
            !peekMatch({Token::Type::RIGHT_BRACE})) {
-        try {
-            stmts.emplace_back(statement());
-        } catch (SyncParser const &) {
+        core::Stmt *stmt = core::ensureStack([&] {
+            return statement();
+        });
+
+        if (stmt == nullptr) {
             synchronize();
+        } else {
+            stmts.emplace_back(stmt);
         }
     }
 
-    consume(
-        Token::Type::RIGHT_BRACE,
-        "expected '}}' at end of block"
-    );
+    if (!consume(
+            Token::Type::RIGHT_BRACE,
+            "expected '}}' at end of block"
+        )) {
+        return nullptr;
+    }
 
     Token rightBrace = previous();
 
@@ -229,402 +583,670 @@ std::unique_ptr<core::Block> Parser::block() {
     );
 }
 
-std::unique_ptr<core::VariableDecl> Parser::variableDecl() {
-    consume(
-        Token::Type::LET,
-        "expected 'let' at the start of variable "
-        "declaration"
-    );
+core::VariableDecl *Parser::variableDecl() {
+    if (!consume(
+            Token::Type::LET,
+            "expected 'let' at the start of variable "
+            "declaration"
+        )) {
+        return nullptr;
+    }
 
-    consume(
-        Token::Type::IDENTIFIER,
-        "expected identifier token "
-        "instead received {}",
-        peek().toString()
-    );
+    if (!consume(
+            Token::Type::IDENTIFIER,
+            "expected identifier token "
+            "instead received {}",
+            peek().toString()
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
+    core::Atom identifier = *token.asOpt<core::Atom>();
 
-    consume(
-        Token::Type::COLON,
-        "expected ':' after identifier"
-    );
+    if (!consume(
+            Token::Type::COLON,
+            "expected ':' after identifier"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Type> type_ = type();
+    core::Type *type_ = type();
 
-    consume(Token::Type::EQUAL, "expected '=' after type");
+    if (type_ == nullptr ||
+        !consume(
+            Token::Type::EQUAL,
+            "expected '=' after type"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> expression = expr();
+    core::Expr *expression = expr();
+
+    if (expression == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::VariableDecl>(
         token.getPosition(),
-        token.getLexeme(),
-        std::move(type_),
-        std::move(expression)
+        identifier,
+        type_,
+        expression
     );
 }
 
-std::unique_ptr<core::Assignment> Parser::assignment() {
-    consume(
-        Token::Type::IDENTIFIER,
-        "expected identifier token "
-        "instead received {}",
-        peek().toString()
-    );
+core::Assignment *Parser::assignment() {
+    if (!consume(
+            Token::Type::IDENTIFIER,
+            "expected identifier token "
+            "instead received {}",
+            peek().toString()
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
+    core::Atom identifier = *token.asOpt<core::Atom>();
 
-    std::unique_ptr<core::Expr> index{};
+    core::Expr *index{};
 
     if (match({Token::Type::LEFT_BRACK})) {
         index = expr();
 
-        consume(
-            Token::Type::RIGHT_BRACK,
-            "expected ']' after integer literal"
-        );
+        if (index == nullptr ||
+            !consume(
+                Token::Type::RIGHT_BRACK,
+                "expected ']' after integer literal"
+            )) {
+            return nullptr;
+        }
     }
 
-    consume(
-        Token::Type::EQUAL,
-        "expected '=' after identifier"
-    );
+    if (!consume(
+            Token::Type::EQUAL,
+            "expected '=' after identifier"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> expr_ = expr();
+    core::Expr *expr_ = expr();
+
+    if (expr_ == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::Assignment>(
         token.getPosition(),
-        token.getLexeme(),
-        std::move(index),
-        std::move(expr_)
+        identifier,
+        index,
+        expr_
     );
 }
 
-std::unique_ptr<core::PrintStmt> Parser::printStatement() {
-    consume(Token::Type::BUILTIN, "expected __print");
+core::PrintStmt *Parser::printStatement() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __print"
+        )) {
+        return nullptr;
+    }
 
     Token print = previous();
 
-    std::unique_ptr<core::Expr> expr_ = expr();
+    core::Expr *expr_ = expr();
+
+    if (expr_ == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::PrintStmt>(
         print.getPosition(),
-        std::move(expr_)
+        expr_
     );
 }
 
-std::unique_ptr<core::DelayStmt> Parser::delayStatement() {
-    consume(Token::Type::BUILTIN, "expected __delay");
+core::DelayStmt *Parser::delayStatement() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __delay"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    std::unique_ptr<core::Expr> expr_ = expr();
+    core::Expr *expr_ = expr();
+
+    if (expr_ == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::DelayStmt>(
         token.getPosition(),
-        std::move(expr_)
+        expr_
     );
 }
 
-std::unique_ptr<core::WriteStmt> Parser::writeStatement() {
-    consume(Token::Type::BUILTIN, "expected __write");
+core::WriteStmt *Parser::writeStatement() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __write"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    std::unique_ptr<core::Expr> x = expr();
+    core::Expr *x = expr();
 
-    consume(
-        Token::Type::COMMA,
-        "expected ',' after expression"
-    );
+    if (x == nullptr ||
+        !consume(
+            Token::Type::COMMA,
+            "expected ',' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> y = expr();
+    core::Expr *y = expr();
 
-    consume(
-        Token::Type::COMMA,
-        "expected ',' after expression"
-    );
+    if (y == nullptr ||
+        !consume(
+            Token::Type::COMMA,
+            "expected ',' after expression"
+        )) {
+        return nullptr;
+    }
+
+    core::Expr *color = expr();
 
-    std::unique_ptr<core::Expr> color = expr();
+    if (color == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::WriteStmt>(
         token.getPosition(),
-        std::move(x),
-        std::move(y),
-        std::move(color)
+        x,
+        y,
+        color
     );
 }
 
-std::unique_ptr<core::ClearStmt> Parser::clearStatement() {
-    consume(Token::Type::BUILTIN, "expected __clear");
+core::ClearStmt *Parser::clearStatement() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __clear"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    std::unique_ptr<core::Expr> color = expr();
+    core::Expr *color = expr();
+
+    if (color == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::ClearStmt>(
         token.getPosition(),
-        std::move(color)
+        color
     );
 }
 
-std::unique_ptr<core::WriteBoxStmt>
-Parser::writeBoxStatement() {
-    consume(Token::Type::BUILTIN, "expected __write_box");
+core::WriteBoxStmt *Parser::writeBoxStatement() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __write_box"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    std::unique_ptr<core::Expr> x = expr();
+    core::Expr *x = expr();
 
-    consume(
-        Token::Type::COMMA,
-        "expected ',' after expression"
-    );
+    if (x == nullptr ||
+        !consume(
+            Token::Type::COMMA,
+            "expected ',' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> y = expr();
+    core::Expr *y = expr();
 
-    consume(
-        Token::Type::COMMA,
-        "expected ',' after expression"
-    );
+    if (y == nullptr ||
+        !consume(
+            Token::Type::COMMA,
+            "expected ',' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> xOffset = expr();
+    core::Expr *xOffset = expr();
 
-    consume(
-        Token::Type::COMMA,
-        "expected ',' after expression"
-    );
+    if (xOffset == nullptr ||
+        !consume(
+            Token::Type::COMMA,
+            "expected ',' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> yOffset = expr();
+    core::Expr *yOffset = expr();
 
-    consume(
-        Token::Type::COMMA,
-        "expected ',' after expression"
-    );
+    if (yOffset == nullptr ||
+        !consume(
+            Token::Type::COMMA,
+            "expected ',' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> color = expr();
+    core::Expr *color = expr();
+
+    if (color == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::WriteBoxStmt>(
         token.getPosition(),
-        std::move(x),
-        std::move(y),
-        std::move(xOffset),
-        std::move(yOffset),
-        std::move(color)
+        x,
+        y,
+        xOffset,
+        yOffset,
+        color
     );
 }
 
-std::unique_ptr<core::IfStmt> Parser::ifStmt() {
-    consume(
-        Token::Type::IF,
-        "expected 'if' at start of if statement"
-    );
+core::IfStmt *Parser::ifStmt() {
+    if (!consume(
+            Token::Type::IF,
+            "expected 'if' at start of if statement"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    consume(
-        Token::Type::LEFT_PAREN,
-        "expected '(' after 'if'"
-    );
+    if (!consume(
+            Token::Type::LEFT_PAREN,
+            "expected '(' after 'if'"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> cond = expr();
+    core::Expr *cond = expr();
 
-    consume(
-        Token::Type::RIGHT_PAREN,
-        "expected ')' after expression"
-    );
+    if (cond == nullptr ||
+        !consume(
+            Token::Type::RIGHT_PAREN,
+            "expected ')' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Block> thenBlock = block();
+    core::Block *thenBlock = block();
 
-    std::unique_ptr<core::Block> elseBlock{};
+    if (thenBlock == nullptr) {
+        return nullptr;
+    }
+
+    core::Block *elseBlock{};
 
     if (match({Token::Type::ELSE})) {
         elseBlock = block();
+
+        if (elseBlock == nullptr) {
+            return nullptr;
+        }
     }
 
     return make_with_pos<core::IfStmt>(
         token.getPosition(),
-        std::move(cond),
-        std::move(thenBlock),
-        std::move(elseBlock)
+        cond,
+        thenBlock,
+        elseBlock
     );
 }
 
-std::unique_ptr<core::ForStmt> Parser::forStmt() {
-    consume(
-        Token::Type::FOR,
-        "expected 'for' at start of for statement"
-    );
+core::ForStmt *Parser::forStmt() {
+    if (!consume(
+            Token::Type::FOR,
+            "expected 'for' at start of for statement"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    consume(
-        Token::Type::LEFT_PAREN,
-        "expected '(' after 'for'"
-    );
+    if (!consume(
+            Token::Type::LEFT_PAREN,
+            "expected '(' after 'for'"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::VariableDecl> decl{};
+    core::VariableDecl *decl{};
 
     if (!peekMatch({Token::Type::SEMICOLON})) {
         decl = variableDecl();
+
+        if (decl == nullptr) {
+            return nullptr;
+        }
     }
 
-    consume(
-        Token::Type::SEMICOLON,
-        "expected ';' after '(' or variable "
-        "declaration"
-    );
+    if (!consume(
+            Token::Type::SEMICOLON,
+            "expected ';' after '(' or variable "
+            "declaration"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> cond = expr();
+    core::Expr *cond = expr();
 
-    consume(
-        Token::Type::SEMICOLON,
-        "expected ';' after expression"
-    );
+    if (cond == nullptr ||
+        !consume(
+            Token::Type::SEMICOLON,
+            "expected ';' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Assignment> assign{};
+    core::Assignment *assign{};
 
     if (!peekMatch({Token::Type::RIGHT_PAREN})) {
         assign = assignment();
+
+        if (assign == nullptr) {
+            return nullptr;
+        }
     }
 
-    consume(
-        Token::Type::RIGHT_PAREN,
-        "expected ')' after ';' or assignment"
-    );
+    if (!consume(
+            Token::Type::RIGHT_PAREN,
+            "expected ')' after ';' or assignment"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Block> block_ = block();
+    core::Block *block_ = block();
+
+    if (block_ == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::ForStmt>(
         token.getPosition(),
-        std::move(decl),
-        std::move(cond),
-        std::move(assign),
-        std::move(block_)
+        decl,
+        cond,
+        assign,
+        block_
     );
 }
 
-std::unique_ptr<core::WhileStmt> Parser::whileStmt() {
-    consume(
-        Token::Type::WHILE,
-        "expected 'while' at start of while statement"
-    );
+core::WhileStmt *Parser::whileStmt() {
+    if (!consume(
+            Token::Type::WHILE,
+            "expected 'while' at start of while statement"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    consume(
-        Token::Type::LEFT_PAREN,
-        "expected '(' after 'while'"
-    );
+    if (!consume(
+            Token::Type::LEFT_PAREN,
+            "expected '(' after 'while'"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> cond = expr();
+    core::Expr *cond = expr();
 
-    consume(
-        Token::Type::RIGHT_PAREN,
-        "expected ')' after expression"
-    );
+    if (cond == nullptr ||
+        !consume(
+            Token::Type::RIGHT_PAREN,
+            "expected ')' after expression"
+        )) {
+        return nullptr;
+    }
+
+    core::Block *block_ = block();
 
-    std::unique_ptr<core::Block> block_ = block();
+    if (block_ == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::WhileStmt>(
         token.getPosition(),
-        std::move(cond),
-        std::move(block_)
+        cond,
+        block_
     );
 }
 
-std::unique_ptr<core::ReturnStmt> Parser::returnStmt() {
-    consume(
-        Token::Type::RETURN,
-        "expected 'return' at start of return "
-        "statement"
-    );
+core::ReturnStmt *Parser::returnStmt() {
+    if (!consume(
+            Token::Type::RETURN,
+            "expected 'return' at start of return "
+            "statement"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
-    std::unique_ptr<core::Expr> expr_ = expr();
+    core::Expr *expr_ = expr();
+
+    if (expr_ == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::ReturnStmt>(
         token.getPosition(),
-        std::move(expr_)
+        expr_
     );
 }
 
-std::unique_ptr<core::FormalParam> Parser::formalParam() {
-    consume(
-        Token::Type::IDENTIFIER,
-        "expected identifier token "
-        "instead received {}",
-        peek().toString()
-    );
+core::FormalParam *Parser::formalParam() {
+    if (!consume(
+            Token::Type::IDENTIFIER,
+            "expected identifier token "
+            "instead received {}",
+            peek().toString()
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
+    core::Atom identifier = *token.asOpt<core::Atom>();
 
-    consume(
-        Token::Type::COLON,
-        "expected ':' after identifier"
-    );
+    if (!consume(
+            Token::Type::COLON,
+            "expected ':' after identifier"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Type> type_ = type();
+    core::Type *type_ = type();
+
+    if (type_ == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::FormalParam>(
         token.getPosition(),
-        token.getLexeme(),
-        std::move(type_)
+        identifier,
+        type_
     );
 }
 
-std::unique_ptr<core::FunctionDecl> Parser::functionDecl() {
-    consume(
-        Token::Type::FUN,
-        "expected 'fun' at start of function "
-        "declaration"
-    );
+core::FunctionDecl *Parser::functionDecl() {
+    if (!consume(
+            Token::Type::FUN,
+            "expected 'fun' at start of function "
+            "declaration"
+        )) {
+        return nullptr;
+    }
 
-    consume(
-        Token::Type::IDENTIFIER,
-        "expected identifier token "
-        "instead received {}",
-        peek().toString()
-    );
+    if (!consume(
+            Token::Type::IDENTIFIER,
+            "expected identifier token "
+            "instead received {}",
+            peek().toString()
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
+    core::Atom identifier = *token.asOpt<core::Atom>();
 
-    consume(
-        Token::Type::LEFT_PAREN,
-        "expected '(' after identifier"
-    );
+    if (!consume(
+            Token::Type::LEFT_PAREN,
+            "expected '(' after identifier"
+        )) {
+        return nullptr;
+    }
 
-    std::vector<std::unique_ptr<core::FormalParam>>
+    std::vector<core::FormalParam *>
         formalParams{};
 
     if (!peekMatch({Token::Type::RIGHT_PAREN})) {
         do {
-            formalParams.emplace_back(formalParam());
+            core::FormalParam *param = formalParam();
+
+            if (param == nullptr) {
+                return nullptr;
+            }
+
+            formalParams.emplace_back(param);
         } while (match({Token::Type::COMMA}));
     }
 
-    consume(
-        Token::Type::RIGHT_PAREN,
-        "expected ')' after formal parameters"
-    );
+    if (!consume(
+            Token::Type::RIGHT_PAREN,
+            "expected ')' after formal parameters"
+        )) {
+        return nullptr;
+    }
+
+    if (!consume(
+            Token::Type::ARROW,
+            "Expected '->' after ')'"
+        )) {
+        return nullptr;
+    }
 
-    consume(Token::Type::ARROW, "Expected '->' after ')'");
+    core::Type *type_ = type();
 
-    std::unique_ptr<core::Type> type_ = type();
+    if (type_ == nullptr) {
+        return nullptr;
+    }
+
+    size_t start = mCurrent;
+    bool isDeferred = mLazyBodies &&
+                      mMode == Mode::TOKEN_STREAM &&
+                      skipBody();
 
-    std::unique_ptr<core::Block> block_ = block();
+    core::Block *block_ = nullptr;
 
-    return make_with_pos<core::FunctionDecl>(
+    if (!isDeferred) {
+        block_ = block();
+
+        if (block_ == nullptr) {
+            return nullptr;
+        }
+    }
+
+    auto *decl = make_with_pos<core::FunctionDecl>(
         token.getPosition(),
-        token.getLexeme(),
+        identifier,
         std::move(formalParams),
-        std::move(type_),
-        std::move(block_)
+        type_,
+        block_
     );
+
+    if (isDeferred) {
+        decl->deferredBody = mDeferredBodies.size();
+        mDeferredBodies.push_back({decl, start});
+    }
+
+    return decl;
+}
+
+// a body whose braces do not match is parsed straight away,
+// so the error is reported where it would have been
+
+bool Parser::skipBody() {
+    size_t depth = 0;
+
+    for (size_t i = mCurrent;; i++) {
+        switch (mStream->getType(i)) {
+            case Token::Type::LEFT_BRACE:
+                depth++;
+                break;
+            case Token::Type::RIGHT_BRACE:
+                // a body starts with its opening brace
+                if (depth == 0)
+                    return false;
+
+                if (--depth == 0) {
+                    mCurrent = i + 1;
+
+                    return true;
+                }
+                break;
+            case Token::Type::END_OF_FILE:
+                return false;
+            default:
+                if (depth == 0)
+                    return false;
+        }
+    }
+}
+
+void Parser::parseDeferred(size_t index) {
+    DeferredBody body = mDeferredBodies[index];
+
+    if (body.decl == nullptr) {
+        return;
+    }
+
+    mDeferredBodies[index].decl = nullptr;
+    body.decl->deferredBody.reset();
+
+    size_t current = mCurrent;
+
+    mCurrent = body.start;
+
+    bool hadError = mHasError;
+    bool isLazy = mLazyBodies;
+
+    mHasError = false;
+    // functions declared within the body are parsed with
+    // it, as a worker would, so errors stay in source order
+    mLazyBodies = false;
+
+    // the statement loops carry on past an error, but what
+    // they are left with is not the body, so it is left out
+    core::Block *block_ = block();
+
+    mLazyBodies = isLazy;
+
+    body.decl->block = mHasError ? nullptr : block_;
+
+    if (body.decl->block != nullptr) {
+        mEmitter.emitBody(body.decl);
+    }
+
+    mHasError = mHasError || hadError;
+    mCurrent = current;
 }
 
-std::unique_ptr<core::Type> Parser::type() {
+core::Type *Parser::type() {
     Token token = advance();
 
     std::optional<core::Base> primitive =
@@ -635,6 +1257,8 @@ std::unique_ptr<core::Type> Parser::type() {
             "expected type token instead received {}",
             token.toString()
         );
+
+        return nullptr;
     }
 
     if (!match({Token::Type::LEFT_BRACK})) {
@@ -655,170 +1279,123 @@ std::unique_ptr<core::Type> Parser::type() {
     // in the syntax and then desugar into a sized. But to
     // do this properly we need to actually separate type
     // inference into its own dedicated phase.
-    std::unique_ptr<core::IntegerLiteral> integer =
+    core::IntegerLiteral *integer =
         integerLiteral();
 
-    consume(
-        Token::Type::RIGHT_BRACK,
-        "expected ']' after integer literal"
-    );
+    if (integer == nullptr ||
+        !consume(
+            Token::Type::RIGHT_BRACK,
+            "expected ']' after integer literal"
+        )) {
+        return nullptr;
+    }
 
     return make_with_pos<core::Type>(
         token.getPosition(),
         *primitive,
         true,
-        std::move(integer)
+        integer
     );
 }
 
-std::unique_ptr<core::Expr> Parser::expr() {
-    std::unique_ptr<core::Expr> expr = logicOr();
-
-    if (match({Token::Type::AS}))
-        expr->type = type();
+core::Expr *Parser::expr() {
+    core::Expr *expr = binary(LOWEST_BINDING_POWER);
 
-    return expr;
-}
-
-std::unique_ptr<core::Expr> Parser::logicOr() {
-    std::unique_ptr<core::Expr> expr = logicAnd();
-
-    while (match({Token::Type::OR})) {
-        Token op = previous();
-
-        std::unique_ptr<core::Expr> right = logicAnd();
-
-        expr = make_with_pos<core::Binary>(
-            op.getPosition(),
-            std::move(expr),
-            *operationFromToken(op),
-            std::move(right)
-        );
+    if (expr == nullptr) {
+        return nullptr;
     }
 
-    return expr;
-}
-
-std::unique_ptr<core::Expr> Parser::logicAnd() {
-    std::unique_ptr<core::Expr> expr = equality();
+    if (match({Token::Type::AS})) {
+        core::Type *type_ = type();
 
-    while (match({Token::Type::AND})) {
-        Token op = previous();
+        if (type_ == nullptr) {
+            return nullptr;
+        }
 
-        std::unique_ptr<core::Expr> right = equality();
+        expr->type = type_;
 
-        expr = make_with_pos<core::Binary>(
-            op.getPosition(),
-            std::move(expr),
-            *operationFromToken(op),
-            std::move(right)
-        );
+        mEmitter.emitCast(expr);
     }
 
     return expr;
 }
 
-std::unique_ptr<core::Expr> Parser::equality() {
-    std::unique_ptr<core::Expr> expr = comparison();
-
-    while (match(
-        {Token::Type::EQUAL_EQUAL, Token::Type::BANG_EQUAL}
-    )) {
-        Token op = previous();
+// NOTE: binary operators are parsed by precedence climbing,
+// an operand is parsed once and the loop then takes every
+// operator which binds at least as tightly as the caller
+// asked for. Operators are left associative, except for
+// equality which has always associated to the right, so a
+// right operand only takes operators binding more tightly,
+// or as tightly for equality.
 
-        std::unique_ptr<core::Expr> right = equality();
+core::Expr *Parser::binary(int minPower) {
+    core::Expr *expr = unary();
 
-        expr = make_with_pos<core::Binary>(
-            op.getPosition(),
-            std::move(expr),
-            *operationFromToken(op),
-            std::move(right)
-        );
+    if (expr == nullptr) {
+        return nullptr;
     }
 
-    return expr;
-}
+    for (;;) {
+        Token::Type type = peekType();
+        int power =
+            BINDING_POWERS[static_cast<size_t>(type)];
 
-std::unique_ptr<core::Expr> Parser::comparison() {
-    std::unique_ptr<core::Expr> expr = term();
+        if (power == NO_BINDING_POWER || power < minPower)
+            return expr;
 
-    while (match(
-        {Token::Type::LESS,
-         Token::Type::LESS_EQUAL,
-         Token::Type::GREATER,
-         Token::Type::GREATER_EQUAL}
-    )) {
-        Token op = previous();
+        core::Operation op = *operationFromType(type);
+        core::Position position = advance().getPosition();
 
-        std::unique_ptr<core::Expr> right = term();
+        bool isRightAssociative =
+            op == core::Operation::EQ ||
+            op == core::Operation::NEQ;
 
-        expr = make_with_pos<core::Binary>(
-            op.getPosition(),
-            std::move(expr),
-            *operationFromToken(op),
-            std::move(right)
-        );
-    }
-
-    return expr;
-}
-
-std::unique_ptr<core::Expr> Parser::term() {
-    std::unique_ptr<core::Expr> expr = factor();
-
-    while (match({Token::Type::PLUS, Token::Type::MINUS})) {
-        Token op = previous();
-
-        std::unique_ptr<core::Expr> right = factor();
-
-        expr = make_with_pos<core::Binary>(
-            op.getPosition(),
-            std::move(expr),
-            *operationFromToken(op),
-            std::move(right)
-        );
-    }
-
-    return expr;
-}
-
-std::unique_ptr<core::Expr> Parser::factor() {
-    std::unique_ptr<core::Expr> expr = unary();
-
-    while (match({Token::Type::STAR, Token::Type::SLASH})) {
-        Token op = previous();
+        core::Expr *right = core::ensureStack([&] {
+            return binary(
+                isRightAssociative ? power : power + 1
+            );
+        });
 
-        std::unique_ptr<core::Expr> right = unary();
+        if (right == nullptr) {
+            return nullptr;
+        }
 
         expr = make_with_pos<core::Binary>(
-            op.getPosition(),
-            std::move(expr),
-            *operationFromToken(op),
-            std::move(right)
+            position,
+            expr,
+            op,
+            right
         );
     }
-
-    return expr;
 }
 
-std::unique_ptr<core::Expr> Parser::unary() {
+core::Expr *Parser::unary() {
     if (match({Token::Type::MINUS, Token::Type::NOT})) {
         Token op = previous();
 
-        std::unique_ptr<core::Expr> expr = unary();
+        core::Expr *expr = core::ensureStack([&] {
+            return unary();
+        });
+
+        if (expr == nullptr) {
+            return nullptr;
+        }
 
         return make_with_pos<core::Unary>(
             op.getPosition(),
             *operationFromToken(op),
-            std::move(expr)
+            expr
         );
     }
 
-    return primary();
+    // sub expressions and arguments nest through here
+    return core::ensureStack([&] {
+        return primary();
+    });
 }
 
-std::unique_ptr<core::Expr> Parser::primary() {
-    Token peekToken = peek();
+core::Expr *Parser::primary() {
+    Token const &peekToken = peek();
 
     switch (peekToken.getType()) {
         case Token::Type::BUILTIN: {
@@ -841,6 +1418,8 @@ std::unique_ptr<core::Expr> Parser::primary() {
                         "statement",
                         peekToken.toString()
                     );
+
+                    return nullptr;
             }
         } break;
         case Token::Type::BOOL:
@@ -870,13 +1449,19 @@ std::unique_ptr<core::Expr> Parser::primary() {
                 "unexpected token {} for primary",
                 peekToken.toString()
             );
+
+            return nullptr;
         }
     }
 }
 
-std::unique_ptr<core::BooleanLiteral>
-Parser::booleanLiteral() {
-    consume(Token::Type::BOOL, "expected boolean literal");
+core::BooleanLiteral *Parser::booleanLiteral() {
+    if (!consume(
+            Token::Type::BOOL,
+            "expected boolean literal"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
@@ -886,8 +1471,13 @@ Parser::booleanLiteral() {
     );
 }
 
-std::unique_ptr<core::ColorLiteral> Parser::colorLiteral() {
-    consume(Token::Type::COLOR, "expected color literal");
+core::ColorLiteral *Parser::colorLiteral() {
+    if (!consume(
+            Token::Type::COLOR,
+            "expected color literal"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
@@ -897,8 +1487,13 @@ std::unique_ptr<core::ColorLiteral> Parser::colorLiteral() {
     );
 }
 
-std::unique_ptr<core::FloatLiteral> Parser::floatLiteral() {
-    consume(Token::Type::FLOAT, "expected float literal");
+core::FloatLiteral *Parser::floatLiteral() {
+    if (!consume(
+            Token::Type::FLOAT,
+            "expected float literal"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
@@ -908,12 +1503,13 @@ std::unique_ptr<core::FloatLiteral> Parser::floatLiteral() {
     );
 }
 
-std::unique_ptr<core::IntegerLiteral>
-Parser::integerLiteral() {
-    consume(
-        Token::Type::INTEGER,
-        "expected integer literal"
-    );
+core::IntegerLiteral *Parser::integerLiteral() {
+    if (!consume(
+            Token::Type::INTEGER,
+            "expected integer literal"
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
 
@@ -923,26 +1519,36 @@ Parser::integerLiteral() {
     );
 }
 
-std::unique_ptr<core::ArrayLiteral> Parser::arrayLiteral() {
-    consume(
-        Token::Type::LEFT_BRACK,
-        "expected '[' at start of array literal"
-    );
+core::ArrayLiteral *Parser::arrayLiteral() {
+    if (!consume(
+            Token::Type::LEFT_BRACK,
+            "expected '[' at start of array literal"
+        )) {
+        return nullptr;
+    }
 
     core::Position position = previous().getPosition();
 
-    std::vector<std::unique_ptr<core::Expr>> exprs{};
+    std::vector<core::Expr *> exprs{};
 
     if (!peekMatch({Token::Type::RIGHT_BRACK})) {
         do {
-            exprs.emplace_back(expr());
+            core::Expr *expr_ = expr();
+
+            if (expr_ == nullptr) {
+                return nullptr;
+            }
+
+            exprs.emplace_back(expr_);
         } while (match({Token::Type::COMMA}));
     }
 
-    consume(
-        Token::Type::RIGHT_BRACK,
-        "expected ']' at end of array literal"
-    );
+    if (!consume(
+            Token::Type::RIGHT_BRACK,
+            "expected ']' at end of array literal"
+        )) {
+        return nullptr;
+    }
 
     return make_with_pos<core::ArrayLiteral>(
         position,
@@ -950,158 +1556,227 @@ std::unique_ptr<core::ArrayLiteral> Parser::arrayLiteral() {
     );
 }
 
-std::unique_ptr<core::PadWidth> Parser::padWidth() {
-    consume(Token::Type::BUILTIN, "expected __width");
+core::PadWidth *Parser::padWidth() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __width"
+        )) {
+        return nullptr;
+    }
 
     return make_with_pos<core::PadWidth>(
         previous().getPosition()
     );
 }
 
-std::unique_ptr<core::PadHeight> Parser::padHeight() {
-    consume(Token::Type::BUILTIN, "expected __height");
+core::PadHeight *Parser::padHeight() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __height"
+        )) {
+        return nullptr;
+    }
 
     return make_with_pos<core::PadHeight>(
         previous().getPosition()
     );
 }
 
-std::unique_ptr<core::PadRead> Parser::padRead() {
-    consume(Token::Type::BUILTIN, "expected __read");
+core::PadRead *Parser::padRead() {
+    if (!consume(Token::Type::BUILTIN, "expected __read")) {
+        return nullptr;
+    }
 
     core::Position position = previous().getPosition();
 
-    std::unique_ptr<core::Expr> x = expr();
+    core::Expr *x = expr();
 
-    consume(
-        Token::Type::COMMA,
-        "expected ',' after expression"
-    );
+    if (x == nullptr ||
+        !consume(
+            Token::Type::COMMA,
+            "expected ',' after expression"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> y = expr();
+    core::Expr *y = expr();
+
+    if (y == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::PadRead>(
         position,
-        std::move(x),
-        std::move(y)
+        x,
+        y
     );
 }
 
-std::unique_ptr<core::PadRandomInt> Parser::padRandomInt() {
-    consume(Token::Type::BUILTIN, "expected __random_int");
+core::PadRandomInt *Parser::padRandomInt() {
+    if (!consume(
+            Token::Type::BUILTIN,
+            "expected __random_int"
+        )) {
+        return nullptr;
+    }
 
     core::Position position = previous().getPosition();
 
-    std::unique_ptr<core::Expr> max = expr();
+    core::Expr *max = expr();
+
+    if (max == nullptr) {
+        return nullptr;
+    }
 
     return make_with_pos<core::PadRandomInt>(
         position,
-        std::move(max)
+        max
     );
 }
 
-std::unique_ptr<core::SubExpr> Parser::subExpr() {
-    consume(
-        Token::Type::LEFT_PAREN,
-        "expected '(' at start of sub expression"
-    );
+core::SubExpr *Parser::subExpr() {
+    if (!consume(
+            Token::Type::LEFT_PAREN,
+            "expected '(' at start of sub expression"
+        )) {
+        return nullptr;
+    }
 
     Token leftParen = previous();
 
-    std::unique_ptr<core::Expr> expr_{expr()};
+    core::Expr *expr_{expr()};
 
-    consume(
-        Token::Type::RIGHT_PAREN,
-        "expected ')' at end of sub expression"
-    );
+    if (expr_ == nullptr ||
+        !consume(
+            Token::Type::RIGHT_PAREN,
+            "expected ')' at end of sub expression"
+        )) {
+        return nullptr;
+    }
 
     return make_with_pos<core::SubExpr>(
         leftParen.getPosition(),
-        std::move(expr_)
+        expr_
     );
 }
 
-std::unique_ptr<core::Variable> Parser::variable() {
-    consume(
-        Token::Type::IDENTIFIER,
-        "expected identifier token "
-        "instead received {}",
-        peek().toString()
-    );
+core::Variable *Parser::variable() {
+    if (!consume(
+            Token::Type::IDENTIFIER,
+            "expected identifier token "
+            "instead received {}",
+            peek().toString()
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
+    core::Atom identifier = *token.asOpt<core::Atom>();
 
     return make_with_pos<core::Variable>(
         token.getPosition(),
-        token.getLexeme()
+        identifier
     );
 }
 
-std::unique_ptr<core::ArrayAccess> Parser::arrayAccess() {
-    consume(
-        Token::Type::IDENTIFIER,
-        "expected identifier token "
-        "instead received {}",
-        peek().toString()
-    );
+core::ArrayAccess *Parser::arrayAccess() {
+    if (!consume(
+            Token::Type::IDENTIFIER,
+            "expected identifier token "
+            "instead received {}",
+            peek().toString()
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
+    core::Atom identifier = *token.asOpt<core::Atom>();
 
-    consume(
-        Token::Type::LEFT_BRACK,
-        "expected '[' after identifier"
-    );
+    if (!consume(
+            Token::Type::LEFT_BRACK,
+            "expected '[' after identifier"
+        )) {
+        return nullptr;
+    }
 
-    std::unique_ptr<core::Expr> expr_{expr()};
+    core::Expr *expr_{expr()};
 
-    consume(
-        Token::Type::RIGHT_BRACK,
-        "expected ']' after expression"
-    );
+    if (expr_ == nullptr ||
+        !consume(
+            Token::Type::RIGHT_BRACK,
+            "expected ']' after expression"
+        )) {
+        return nullptr;
+    }
 
     return make_with_pos<core::ArrayAccess>(
         token.getPosition(),
-        token.getLexeme(),
-        std::move(expr_)
+        identifier,
+        expr_
     );
 }
 
-std::unique_ptr<core::FunctionCall> Parser::functionCall() {
-    consume(
-        Token::Type::IDENTIFIER,
-        "expected identifier token "
-        "instead received {}",
-        peek().toString()
-    );
+core::FunctionCall *Parser::functionCall() {
+    if (!consume(
+            Token::Type::IDENTIFIER,
+            "expected identifier token "
+            "instead received {}",
+            peek().toString()
+        )) {
+        return nullptr;
+    }
 
     Token token = previous();
+    core::Atom identifier = *token.asOpt<core::Atom>();
 
-    consume(
-        Token::Type::LEFT_PAREN,
-        "expected '(' after identifier"
-    );
+    if (!consume(
+            Token::Type::LEFT_PAREN,
+            "expected '(' after identifier"
+        )) {
+        return nullptr;
+    }
 
-    std::vector<std::unique_ptr<core::Expr>> params{};
+    std::vector<core::Expr *> params{};
 
     if (!peekMatch({Token::Type::RIGHT_PAREN})) {
         do {
-            params.emplace_back(expr());
+            core::Expr *param = expr();
+
+            if (param == nullptr) {
+                return nullptr;
+            }
+
+            params.emplace_back(param);
         } while (match({Token::Type::COMMA}));
     }
 
-    consume(
-        Token::Type::RIGHT_PAREN,
-        "expected ')' after parameters"
-    );
+    if (!consume(
+            Token::Type::RIGHT_PAREN,
+            "expected ')' after parameters"
+        )) {
+        return nullptr;
+    }
 
     return make_with_pos<core::FunctionCall>(
         token.getPosition(),
-        token.getLexeme(),
+        identifier,
         std::move(params)
     );
 }
 
 void Parser::initWindow() {
+    if (mMode == Mode::TOKEN_STREAM) {
+        mTokens.fill(mLexer, mSource, mLexerThreads);
+        mStream = &mTokens;
+        mCurrent = 0;
+
+        return;
+    }
+
+    if (mMode == Mode::PIPELINED) {
+        startPipeline();
+    }
+
     for (int i = 0; i < LOOKAHEAD; i++) {
         mTokenBuffer[i] = nextToken();
     }
@@ -1110,6 +1785,14 @@ void Parser::initWindow() {
 }
 
 void Parser::moveWindow() {
+    // past the end the stream keeps giving end of file
+    // tokens, like the lexer does
+    if (mMode == Mode::TOKEN_STREAM) {
+        mCurrent++;
+
+        return;
+    }
+
     mPreviousToken = mTokenBuffer[0];
 
     for (int i = 1; i < LOOKAHEAD; i++) {
@@ -1117,16 +1800,85 @@ void Parser::moveWindow() {
     }
 
     mTokenBuffer[LOOKAHEAD - 1] = nextToken();
+
+    if (mMode == Mode::WINDOWED) {
+        mLexer.release(mPreviousToken.getPosition());
+    }
 }
 
+// NOTE: only the lexer thread touches the lexer while the
+// pipeline is running, the parser just reads the line map,
+// which is complete since the source was added up front
+
+void Parser::startPipeline() {
+    stopPipeline();
+
+    mQueue.reset();
+    mEndOfFile.reset();
+    mLexer.setDeferErrors(true);
+
+    mLexerThread = std::thread(&Parser::lexAhead, this);
+}
+
+void Parser::stopPipeline() {
+    if (!mLexerThread.joinable())
+        return;
+
+    mQueue.close();
+    mLexerThread.join();
+
+    mLexer.setDeferErrors(false);
+}
+
+void Parser::lexAhead() {
+    for (;;) {
+        std::optional<Token> token = mLexer.nextToken();
+
+        bool isAtEnd =
+            token.has_value() &&
+            token->getType() == Token::Type::END_OF_FILE;
+
+        if (!mQueue.push({token, mLexer.takeError()}) ||
+            isAtEnd)
+            return;
+    }
+}
+
+// NOTE: the lexer is put in trivia skipping mode by the
+// parser so only erroneous lexemes have to be skipped here.
+// Also, a lexeme is only guaranteed to be valid while its
+// token is in the window (or is the previous token), the
+// tree refers to identifiers by the atoms they were
+// interned as instead.
+
 Token Parser::nextToken() {
+    if (mMode == Mode::PIPELINED) {
+        // the lexer thread is done after the end of file
+        if (mEndOfFile.has_value())
+            return *mEndOfFile;
+
+        for (;;) {
+            TokenQueue::Entry entry = mQueue.pop();
+
+            if (entry.error.has_value())
+                fmt::println(stderr, "{}", *entry.error);
+
+            if (!entry.token.has_value())
+                continue;
+
+            if (entry.token->getType() ==
+                Token::Type::END_OF_FILE)
+                mEndOfFile = entry.token;
+
+            return *entry.token;
+        }
+    }
+
     std::optional<Token> token;
 
     do {
         token = mLexer.nextToken();
-    } while (!token.has_value() ||
-             token->getType() == Token::Type::WHITESPACE ||
-             token->getType() == Token::Type::COMMENT);
+    } while (!token.has_value());
 
     return *token;
 }
@@ -1136,6 +1888,9 @@ Token Parser::peek() {
 }
 
 Token Parser::peek(int lookahead) {
+    if (mMode == Mode::TOKEN_STREAM)
+        return mStream->get(mCurrent + lookahead);
+
     core::abort_if(
         !(0 <= lookahead && lookahead < LOOKAHEAD),
         "exceeded lookahead of {}",
@@ -1148,15 +1903,18 @@ Token Parser::peek(int lookahead) {
 Token Parser::advance() {
     moveWindow();
 
-    return mPreviousToken;
+    return previous();
 }
 
 Token Parser::previous() {
+    if (mMode == Mode::TOKEN_STREAM)
+        return mStream->get(mCurrent == 0 ? 0 : mCurrent - 1);
+
     return mPreviousToken;
 }
 
 bool Parser::isAtEnd() {
-    return peek().getType() == Token::Type::END_OF_FILE;
+    return peekType() == Token::Type::END_OF_FILE;
 }
 
 bool Parser::check(Token::Type type) {
@@ -1164,7 +1922,16 @@ bool Parser::check(Token::Type type) {
         return false;
     }
 
-    return peek().getType() == type;
+    return peekType() == type;
+}
+
+// checking a kind does not need the whole token
+
+Token::Type Parser::peekType() {
+    if (mMode == Mode::TOKEN_STREAM)
+        return mStream->getType(mCurrent);
+
+    return mTokenBuffer[0].getType();
 }
 
 bool Parser::peekMatch(
@@ -1195,7 +1962,7 @@ bool Parser::match(
 
 void Parser::synchronize() {
     while (!isAtEnd()) {
-        Token peekToken = peek();
+        Token const &peekToken = peek();
 
         switch (peekToken.getType()) {
             case Token::Type::SEMICOLON:
@@ -1244,7 +2011,7 @@ void Parser::synchronize() {
 }
 
 std::optional<core::Base> Parser::primitiveFromToken(
-    Token &token
+    Token const &token
 ) {
     switch (token.getType()) {
         case Token::Type::BOOL_TYPE:
@@ -1261,38 +2028,9 @@ std::optional<core::Base> Parser::primitiveFromToken(
 }
 
 std::optional<core::Operation> Parser::operationFromToken(
-    Token &token
+    Token const &token
 ) {
-    switch (token.getType()) {
-        case Token::Type::PLUS:
-            return {core::Operation::ADD};
-        case Token::Type::AND:
-            return {core::Operation::AND};
-        case Token::Type::SLASH:
-            return {core::Operation::DIV};
-        case Token::Type::EQUAL_EQUAL:
-            return {core::Operation::EQ};
-        case Token::Type::GREATER_EQUAL:
-            return {core::Operation::GE};
-        case Token::Type::GREATER:
-            return {core::Operation::GT};
-        case Token::Type::LESS:
-            return {core::Operation::LT};
-        case Token::Type::LESS_EQUAL:
-            return {core::Operation::LE};
-        case Token::Type::STAR:
-            return {core::Operation::MUL};
-        case Token::Type::BANG_EQUAL:
-            return {core::Operation::NEQ};
-        case Token::Type::NOT:
-            return {core::Operation::NOT};
-        case Token::Type::OR:
-            return {core::Operation::OR};
-        case Token::Type::MINUS:
-            return {core::Operation::SUB};
-        default:
-            return {};
-    }
+    return operationFromType(token.getType());
 }
 
 }  // namespace PArL
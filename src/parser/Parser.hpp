@@ -1,13 +1,25 @@
 #pragma once
 
 // std
+#include <array>
+#include <cstdint>
 #include <initializer_list>
+#include <istream>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 // parl
 #include <lexer/Lexer.hpp>
+#include <lexer/TokenQueue.hpp>
+#include <lexer/TokenStream.hpp>
 #include <parl/AST.hpp>
+#include <parl/FlatAST.hpp>
 #include <parl/Token.hpp>
+#include <parser/FlatEmitter.hpp>
 
 // fmt
 #include <fmt/core.h>
@@ -17,73 +29,134 @@
 
 namespace PArL {
 
-class SyncParser : public std::exception {};
-
 class Parser {
    public:
+    // NOTE: a windowed parser pulls tokens from the lexer as
+    // it goes and can only look LOOKAHEAD tokens ahead. When
+    // parsing a token stream the whole source is lexed first,
+    // so lexical errors are all reported before any parsing
+    // error, but any token can be looked at. A pipelined
+    // parser is windowed but the lexer runs ahead of it on a
+    // thread of its own.
+    enum class Mode {
+        WINDOWED,
+        TOKEN_STREAM,
+        PIPELINED,
+    };
+
     explicit Parser(Lexer& lexer);
+    ~Parser();
+
+    void setMode(Mode mode);
+
+    // only a token stream is lexed on more than one thread
+    void setLexerThreads(size_t noOfThreads);
+    // bodies left for later are parsed all at once on this
+    // many threads, the rest of the program is not
+    void setParserThreads(size_t noOfThreads);
+
+    // NOTE: a lazy token stream parser only matches the
+    // braces of a function body, the body is parsed on first
+    // need, one function at a time or all at once. Errors in
+    // a body are reported when it is parsed.
+    void setLazyBodies(bool isLazy);
+
+    // both leave bodies which were already parsed alone, a
+    // body which cannot be parsed is left out. Once every
+    // body is in, the flat tree is renumbered, see
+    // FlatEmitter.hpp, and the errors kept back by a lazy
+    // parser are printed
+    void parseBody(core::FunctionDecl* decl);
+    void parseBodies();
 
     [[nodiscard]] bool hasError() const;
 
-    void parse(std::string const& source);
+    void parse(std::string_view source);
+    void parse(std::istream& stream);
 
-    std::unique_ptr<core::Program> getAst();
+    // the tree owns the arena its nodes are allocated from
+    // and the flat tree emitted as they were made
+    core::Tree getAst();
+    // the tree without the bodies a lazy parser left for
+    // later, parseBody makes each in the tree's arena and
+    // flat tree, so the tree has to outlive the calls
+    core::Tree getLazyAst();
 
     void reset();
 
    private:
-    std::unique_ptr<core::Type> type();
-
-    std::unique_ptr<core::Program> program();
-    std::unique_ptr<core::Stmt> statement();
-    std::unique_ptr<core::Block> block();
-    std::unique_ptr<core::VariableDecl> variableDecl();
-    std::unique_ptr<core::Assignment> assignment();
-    std::unique_ptr<core::PrintStmt> printStatement();
-    std::unique_ptr<core::DelayStmt> delayStatement();
-    std::unique_ptr<core::WriteBoxStmt> writeBoxStatement();
-    std::unique_ptr<core::WriteStmt> writeStatement();
-    std::unique_ptr<core::ClearStmt> clearStatement();
-    std::unique_ptr<core::IfStmt> ifStmt();
-    std::unique_ptr<core::ForStmt> forStmt();
-    std::unique_ptr<core::WhileStmt> whileStmt();
-    std::unique_ptr<core::ReturnStmt> returnStmt();
-    std::unique_ptr<core::FunctionDecl> functionDecl();
-    std::unique_ptr<core::FormalParam> formalParam();
-
-    std::unique_ptr<core::PadWidth> padWidth();
-    std::unique_ptr<core::PadHeight> padHeight();
-    std::unique_ptr<core::PadRead> padRead();
-    std::unique_ptr<core::PadRandomInt> padRandomInt();
-    std::unique_ptr<core::BooleanLiteral> booleanLiteral();
-    std::unique_ptr<core::ColorLiteral> colorLiteral();
-    std::unique_ptr<core::FloatLiteral> floatLiteral();
-    std::unique_ptr<core::IntegerLiteral> integerLiteral();
-    std::unique_ptr<core::ArrayLiteral> arrayLiteral();
-    std::unique_ptr<core::SubExpr> subExpr();
-    std::unique_ptr<core::Variable> variable();
-    std::unique_ptr<core::ArrayAccess> arrayAccess();
-    std::unique_ptr<core::FunctionCall> functionCall();
-
-    std::unique_ptr<core::Expr> expr();
-    std::unique_ptr<core::Expr> logicOr();
-    std::unique_ptr<core::Expr> logicAnd();
-    std::unique_ptr<core::Expr> equality();
-    std::unique_ptr<core::Expr> comparison();
-    std::unique_ptr<core::Expr> term();
-    std::unique_ptr<core::Expr> factor();
-    std::unique_ptr<core::Expr> unary();
-    std::unique_ptr<core::Expr> primary();
+    // a worker parses bodies out of the token stream of
+    // another parser
+    Parser(Lexer& lexer, TokenStream const* stream);
+
+    // a deferred function keeps the index of its body here
+    struct DeferredBody {
+        core::FunctionDecl* decl;
+        // the index of the opening brace
+        size_t start;
+    };
+
+    template <typename T, typename... Args>
+    T* make_with_pos(core::Position pos, Args&&... args);
+
+    core::Type* type();
+
+    bool skipBody();
+    void parseDeferred(size_t index);
+    void parseDeferredInParallel();
+    void printErrors();
+
+    core::Program* program();
+    core::Stmt* statement();
+    core::Block* block();
+    core::VariableDecl* variableDecl();
+    core::Assignment* assignment();
+    core::PrintStmt* printStatement();
+    core::DelayStmt* delayStatement();
+    core::WriteBoxStmt* writeBoxStatement();
+    core::WriteStmt* writeStatement();
+    core::ClearStmt* clearStatement();
+    core::IfStmt* ifStmt();
+    core::ForStmt* forStmt();
+    core::WhileStmt* whileStmt();
+    core::ReturnStmt* returnStmt();
+    core::FunctionDecl* functionDecl();
+    core::FormalParam* formalParam();
+
+    core::PadWidth* padWidth();
+    core::PadHeight* padHeight();
+    core::PadRead* padRead();
+    core::PadRandomInt* padRandomInt();
+    core::BooleanLiteral* booleanLiteral();
+    core::ColorLiteral* colorLiteral();
+    core::FloatLiteral* floatLiteral();
+    core::IntegerLiteral* integerLiteral();
+    core::ArrayLiteral* arrayLiteral();
+    core::SubExpr* subExpr();
+    core::Variable* variable();
+    core::ArrayAccess* arrayAccess();
+    core::FunctionCall* functionCall();
+
+    core::Expr* expr();
+    core::Expr* binary(int minPower);
+    core::Expr* unary();
+    core::Expr* primary();
 
     void initWindow();
     void moveWindow();
 
+    void startPipeline();
+    void stopPipeline();
+    void lexAhead();
+
     Token nextToken();
     Token peek();
     Token peek(int lookahead);
     Token advance();
     Token previous();
 
+    Token::Type peekType();
+
     bool isAtEnd();
     bool check(Token::Type type);
     bool peekMatch(
@@ -93,49 +166,91 @@ class Parser {
         std::initializer_list<Token::Type> const& types
     );
 
+    // NOTE: errors are not thrown, a parse function which
+    // meets one reports it and returns nullptr, as does any
+    // function which gets nullptr back. The statement loops
+    // then synchronize and carry on.
+
     template <typename... T>
-    void consume(
+    [[nodiscard]] bool consume(
         Token::Type type,
         fmt::format_string<T...> fmt,
         T&&... args
     ) {
         if (check(type)) {
             advance();
-        } else {
-            error(fmt, args...);
+
+            return true;
         }
+
+        error(fmt, args...);
+
+        return false;
     }
 
     template <typename... T>
     void error(fmt::format_string<T...> fmt, T&&... args) {
         mHasError = true;
 
-        Token violatingToken = peek();
+        core::Position position = peek().getPosition();
+        core::LineMap const& lineMap = mLexer.getLineMap();
 
-        fmt::println(
-            stderr,
+        std::string message = fmt::format(
             "parsing error at {}:{}:: {}",
-            violatingToken.getPosition().row(),
-            violatingToken.getPosition().col(),
+            lineMap.row(position),
+            lineMap.col(position),
             fmt::format(fmt, args...)
         );
 
-        throw SyncParser{};
+        // errors are kept back while bodies may be left for
+        // later, and printed in source order once they are in
+        if (mDeferErrors) {
+            mErrors.push_back({position.offset(), message});
+        } else {
+            fmt::println(stderr, "{}", message);
+        }
     }
 
     void synchronize();
 
     static std::optional<core::Base> primitiveFromToken(
-        Token& token
+        Token const& token
     );
     static std::optional<core::Operation>
-    operationFromToken(Token& token);
+    operationFromToken(Token const& token);
 
     Lexer& mLexer;
+    Mode mMode{Mode::WINDOWED};
     bool mHasError{false};
-    std::unique_ptr<core::Program> mAst{};
+    bool mDeferErrors{false};
+    std::vector<std::pair<uint32_t, std::string>> mErrors{};
+    std::unique_ptr<core::Arena> mArena{};
+    // where nodes are made, the arena above until a lazy
+    // tree takes it and keeps it for the bodies left out
+    core::Arena* mNodes{nullptr};
+    core::Program* mAst{nullptr};
+    FlatEmitter mEmitter{};
+
+    // windowed
     Token mPreviousToken;
     std::array<Token, LOOKAHEAD> mTokenBuffer;
+
+    // token stream
+    std::string_view mSource{};
+    std::string mStreamSource{};
+    TokenStream mTokens{};
+    // the stream being parsed, a worker's is not its own
+    TokenStream const* mStream{nullptr};
+    size_t mLexerThreads{1};
+    size_t mParserThreads{1};
+    size_t mCurrent{0};
+    bool mLazyBodies{false};
+    std::vector<DeferredBody> mDeferredBodies{};
+
+    // pipelined
+    TokenQueue mQueue{};
+    std::thread mLexerThread{};
+    std::optional<Token> mEndOfFile{};
 };
 
 }  // namespace PArL
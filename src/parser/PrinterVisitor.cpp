@@ -4,6 +4,10 @@
 
 namespace PArL {
 
+PrinterVisitor::PrinterVisitor(core::Interner const &interner)
+    : mInterner(interner) {
+}
+
 void PrinterVisitor::visit(core::Type *type) {
     std::string primitive = baseToString(type->base);
     if (type->isArray) {
@@ -106,13 +110,19 @@ void PrinterVisitor::visit(core::ArrayLiteral *literal) {
 }
 
 void PrinterVisitor::visit(core::Variable *expr) {
-    print_with_tabs("Variable {}", expr->identifier);
+    print_with_tabs(
+        "Variable {}",
+        mInterner.name(expr->identifier)
+    );
 
     expr->core::Expr::accept(this);
 }
 
 void PrinterVisitor::visit(core::ArrayAccess *expr) {
-    print_with_tabs("Array Access {} =>", expr->identifier);
+    print_with_tabs(
+        "Array Access {} =>",
+        mInterner.name(expr->identifier)
+    );
 
     mTabCount++;
     expr->index->accept(this);
@@ -124,7 +134,7 @@ void PrinterVisitor::visit(core::ArrayAccess *expr) {
 void PrinterVisitor::visit(core::FunctionCall *expr) {
     print_with_tabs(
         "Function Call {} =>",
-        expr->identifier
+        mInterner.name(expr->identifier)
     );
     mTabCount++;
     for (auto &param : expr->params) {
@@ -165,7 +175,10 @@ void PrinterVisitor::visit(core::Unary *expr) {
 }
 
 void PrinterVisitor::visit(core::Assignment *stmt) {
-    print_with_tabs("Assign {} =>", stmt->identifier);
+    print_with_tabs(
+        "Assign {} =>",
+        mInterner.name(stmt->identifier)
+    );
 
     if (stmt->index) {
         mTabCount++;
@@ -181,7 +194,10 @@ void PrinterVisitor::visit(core::Assignment *stmt) {
 }
 
 void PrinterVisitor::visit(core::VariableDecl *stmt) {
-    print_with_tabs("let {} : ", stmt->identifier);
+    print_with_tabs(
+        "let {} : ",
+        mInterner.name(stmt->identifier)
+    );
 
     mTabCount++;
     stmt->type->accept(this);
@@ -297,7 +313,7 @@ void PrinterVisitor::visit(core::ReturnStmt *stmt) {
 void PrinterVisitor::visit(core::FormalParam *param) {
     print_with_tabs(
         "Formal Param {} =>",
-        param->identifier
+        mInterner.name(param->identifier)
     );
 
     mTabCount++;
@@ -306,7 +322,10 @@ void PrinterVisitor::visit(core::FormalParam *param) {
 }
 
 void PrinterVisitor::visit(core::FunctionDecl *stmt) {
-    print_with_tabs("Func Decl {} =>", stmt->identifier);
+    print_with_tabs(
+        "Func Decl {} =>",
+        mInterner.name(stmt->identifier)
+    );
     mTabCount++;
     for (auto &param : stmt->params) {
         param->accept(this);
@@ -4,12 +4,15 @@
 #include <fmt/core.h>
 
 // parl
+#include <parl/Interner.hpp>
 #include <parl/Visitor.hpp>
 
 namespace PArL {
 
 class PrinterVisitor : public core::Visitor {
    public:
+    explicit PrinterVisitor(core::Interner const &interner);
+
     void visit(core::Type *) override;
     void visit(core::Expr *) override;
     void visit(core::PadWidth *) override;
@@ -58,6 +61,8 @@ class PrinterVisitor : public core::Visitor {
     }
 
    private:
+    core::Interner const &mInterner;
+
     int mTabCount = 0;
 };
 
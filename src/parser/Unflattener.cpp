@@ -0,0 +1,564 @@
+// parl
+#include <parl/Stack.hpp>
+#include <parser/Unflattener.hpp>
+
+namespace PArL {
+
+using Kind = core::FlatTree::Kind;
+
+namespace {
+
+// the kinds of expressions and then of statements follow
+// one another in Kind
+
+constexpr bool isExpr(Kind kind) {
+    return kind >= Kind::PAD_WIDTH && kind <= Kind::UNARY;
+}
+
+constexpr bool isStmt(Kind kind) {
+    return kind >= Kind::ASSIGNMENT &&
+           kind <= Kind::RETURN &&
+           kind != Kind::FORMAL_PARAM;
+}
+
+constexpr bool isBase(uint8_t tag) {
+    return tag <= static_cast<uint8_t>(core::Base::INT);
+}
+
+constexpr bool isBinaryOperation(uint8_t tag) {
+    auto op = static_cast<core::Operation>(tag);
+
+    return tag <=
+               static_cast<uint8_t>(core::Operation::SUB) &&
+           op != core::Operation::NOT;
+}
+
+constexpr bool hasAtom(Kind kind) {
+    switch (kind) {
+        case Kind::VARIABLE:
+        case Kind::ARRAY_ACCESS:
+        case Kind::FUNCTION_CALL:
+        case Kind::ASSIGNMENT:
+        case Kind::VARIABLE_DECL:
+        case Kind::FORMAL_PARAM:
+        case Kind::FUNCTION_DECL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// the parser makes a unary node out of a minus or a not
+constexpr bool isUnaryOperation(uint8_t tag) {
+    auto op = static_cast<core::Operation>(tag);
+
+    return op == core::Operation::SUB ||
+           op == core::Operation::NOT;
+}
+
+}  // namespace
+
+Unflattener::Unflattener(
+    core::FlatTree tree,
+    std::vector<core::Atom> const &atoms
+)
+    : mTree(std::move(tree)), mAtoms(atoms) {
+}
+
+std::optional<core::Tree> Unflattener::unflatten() {
+    mArena = std::make_unique<core::Arena>();
+    mClaimed.assign(mTree.size(), false);
+    mHasError = false;
+
+    auto *program =
+        node<core::Program>(mTree.root(), Kind::PROGRAM);
+
+    if (mHasError) {
+        return {};
+    }
+
+    // every node built had its atom checked
+    for (core::NodeId id = 0; id < mTree.size(); id++) {
+        core::FlatTree::Node const &flat = mTree.node(id);
+
+        if (mClaimed[id] && hasAtom(flat.kind)) {
+            mTree.setAtom(id, mAtoms[flat.a]);
+        }
+    }
+
+    return core::Tree{
+        std::move(mArena),
+        program,
+        std::make_unique<core::FlatTree>(std::move(mTree))
+    };
+}
+
+template <typename T>
+T *Unflattener::node(core::NodeId id, Kind kind) {
+    if (!claim(id) || mTree.node(id).kind != kind) {
+        return fail();
+    }
+
+    return static_cast<T *>(build(id));
+}
+
+template <typename T>
+T *Unflattener::optionalNode(core::NodeId id, Kind kind) {
+    if (id == NO_NODE) {
+        return nullptr;
+    }
+
+    return node<T>(id, kind);
+}
+
+core::Expr *Unflattener::expr(core::NodeId id) {
+    if (!claim(id) || !isExpr(mTree.node(id).kind)) {
+        return fail();
+    }
+
+    return static_cast<core::Expr *>(build(id));
+}
+
+core::Expr *Unflattener::optionalExpr(core::NodeId id) {
+    if (id == NO_NODE) {
+        return nullptr;
+    }
+
+    return expr(id);
+}
+
+core::Stmt *Unflattener::stmt(core::NodeId id) {
+    if (!claim(id) || !isStmt(mTree.node(id).kind)) {
+        return fail();
+    }
+
+    return static_cast<core::Stmt *>(build(id));
+}
+
+std::vector<core::Expr *> Unflattener::exprs(
+    core::FlatTree::Children ids
+) {
+    std::vector<core::Expr *> exprs{};
+
+    exprs.reserve(ids.size());
+
+    for (core::NodeId id : ids) {
+        exprs.push_back(expr(id));
+    }
+
+    return exprs;
+}
+
+std::vector<core::Stmt *> Unflattener::stmts(
+    core::FlatTree::Children ids
+) {
+    std::vector<core::Stmt *> stmts{};
+
+    stmts.reserve(ids.size());
+
+    for (core::NodeId id : ids) {
+        stmts.push_back(stmt(id));
+    }
+
+    return stmts;
+}
+
+core::Node *Unflattener::build(core::NodeId id) {
+    core::Node *built = core::ensureStack([&] {
+        return buildNode(id);
+    });
+
+    if (built != nullptr) {
+        built->flatId = id;
+    }
+
+    return built;
+}
+
+core::Node *Unflattener::buildNode(core::NodeId id) {
+    core::FlatTree::Node const &flat = mTree.node(id);
+    core::Position position{flat.position};
+
+    if (flat.cast != NO_NODE && !isExpr(flat.kind)) {
+        return fail();
+    }
+
+    core::Expr *built = nullptr;
+
+    switch (flat.kind) {
+        case Kind::TYPE: {
+            // as parsed, an array always has a size
+            bool isArray = flat.a != 0;
+
+            if (!isBase(flat.tag) ||
+                isArray != (flat.b != NO_NODE)) {
+                return fail();
+            }
+
+            return make_with_pos<core::Type>(
+                position,
+                mTree.base(id),
+                isArray,
+                optionalNode<core::IntegerLiteral>(
+                    flat.b,
+                    Kind::INTEGER_LITERAL
+                )
+            );
+        }
+        case Kind::PAD_WIDTH:
+            built =
+                make_with_pos<core::PadWidth>(position);
+            break;
+        case Kind::PAD_HEIGHT:
+            built =
+                make_with_pos<core::PadHeight>(position);
+            break;
+        case Kind::PAD_READ: {
+            core::Expr *x = expr(flat.a);
+            core::Expr *y = expr(flat.b);
+
+            built = make_with_pos<core::PadRead>(
+                position,
+                x,
+                y
+            );
+        } break;
+        case Kind::PAD_RANDOM_INT:
+            built = make_with_pos<core::PadRandomInt>(
+                position,
+                expr(flat.a)
+            );
+            break;
+        case Kind::BOOLEAN_LITERAL:
+            built = make_with_pos<core::BooleanLiteral>(
+                position,
+                mTree.boolValue(id)
+            );
+            break;
+        case Kind::INTEGER_LITERAL:
+            built = make_with_pos<core::IntegerLiteral>(
+                position,
+                mTree.intValue(id)
+            );
+            break;
+        case Kind::FLOAT_LITERAL:
+            built = make_with_pos<core::FloatLiteral>(
+                position,
+                mTree.floatValue(id)
+            );
+            break;
+        case Kind::COLOR_LITERAL:
+            built = make_with_pos<core::ColorLiteral>(
+                position,
+                mTree.colorValue(id)
+            );
+            break;
+        case Kind::ARRAY_LITERAL:
+            built = make_with_pos<core::ArrayLiteral>(
+                position,
+                exprs(list(flat.a, flat.b))
+            );
+            break;
+        case Kind::VARIABLE:
+            built = make_with_pos<core::Variable>(
+                position,
+                atom(flat.a)
+            );
+            break;
+        case Kind::ARRAY_ACCESS:
+            built = make_with_pos<core::ArrayAccess>(
+                position,
+                atom(flat.a),
+                expr(flat.b)
+            );
+            break;
+        case Kind::FUNCTION_CALL:
+            built = make_with_pos<core::FunctionCall>(
+                position,
+                atom(flat.a),
+                exprs(list(flat.b, flat.c))
+            );
+            break;
+        case Kind::SUB_EXPR:
+            built = make_with_pos<core::SubExpr>(
+                position,
+                expr(flat.a)
+            );
+            break;
+        case Kind::BINARY: {
+            if (!isBinaryOperation(flat.tag)) {
+                return fail();
+            }
+
+            core::Expr *left = expr(flat.a);
+            core::Expr *right = expr(flat.b);
+
+            built = make_with_pos<core::Binary>(
+                position,
+                left,
+                mTree.operation(id),
+                right
+            );
+        } break;
+        case Kind::UNARY:
+            if (!isUnaryOperation(flat.tag)) {
+                return fail();
+            }
+
+            built = make_with_pos<core::Unary>(
+                position,
+                mTree.operation(id),
+                expr(flat.a)
+            );
+            break;
+        case Kind::ASSIGNMENT: {
+            core::Expr *index = optionalExpr(flat.b);
+            core::Expr *value = expr(flat.c);
+
+            return make_with_pos<core::Assignment>(
+                position,
+                atom(flat.a),
+                index,
+                value
+            );
+        }
+        case Kind::VARIABLE_DECL: {
+            auto *type =
+                node<core::Type>(flat.b, Kind::TYPE);
+            core::Expr *value = expr(flat.c);
+
+            return make_with_pos<core::VariableDecl>(
+                position,
+                atom(flat.a),
+                type,
+                value
+            );
+        }
+        case Kind::PRINT:
+            return make_with_pos<core::PrintStmt>(
+                position,
+                expr(flat.a)
+            );
+        case Kind::DELAY:
+            return make_with_pos<core::DelayStmt>(
+                position,
+                expr(flat.a)
+            );
+        case Kind::WRITE_BOX: {
+            if (flat.b != 5) {
+                return fail();
+            }
+
+            std::vector<core::Expr *> args =
+                exprs(list(flat.a, flat.b));
+
+            if (mHasError) {
+                return nullptr;
+            }
+
+            return make_with_pos<core::WriteBoxStmt>(
+                position,
+                args[0],
+                args[1],
+                args[2],
+                args[3],
+                args[4]
+            );
+        }
+        case Kind::WRITE: {
+            if (flat.b != 3) {
+                return fail();
+            }
+
+            std::vector<core::Expr *> args =
+                exprs(list(flat.a, flat.b));
+
+            if (mHasError) {
+                return nullptr;
+            }
+
+            return make_with_pos<core::WriteStmt>(
+                position,
+                args[0],
+                args[1],
+                args[2]
+            );
+        }
+        case Kind::CLEAR:
+            return make_with_pos<core::ClearStmt>(
+                position,
+                expr(flat.a)
+            );
+        case Kind::BLOCK:
+            return make_with_pos<core::Block>(
+                position,
+                stmts(list(flat.a, flat.b))
+            );
+        case Kind::FORMAL_PARAM:
+            return make_with_pos<core::FormalParam>(
+                position,
+                atom(flat.a),
+                node<core::Type>(flat.b, Kind::TYPE)
+            );
+        case Kind::FUNCTION_DECL: {
+            if (flat.c > UINT32_MAX - 2) {
+                return fail();
+            }
+
+            // the parameters are followed by the type and
+            // the block
+            core::FlatTree::Children ids =
+                list(flat.b, flat.c + 2);
+
+            if (mHasError) {
+                return nullptr;
+            }
+
+            std::vector<core::FormalParam *> params{};
+
+            for (size_t i = 0; i < flat.c; i++) {
+                params.push_back(node<core::FormalParam>(
+                    ids[i],
+                    Kind::FORMAL_PARAM
+                ));
+            }
+
+            auto *type = node<core::Type>(
+                ids[flat.c],
+                Kind::TYPE
+            );
+            auto *block = node<core::Block>(
+                ids[flat.c + 1],
+                Kind::BLOCK
+            );
+
+            return make_with_pos<core::FunctionDecl>(
+                position,
+                atom(flat.a),
+                std::move(params),
+                type,
+                block
+            );
+        }
+        case Kind::IF: {
+            core::Expr *cond = expr(flat.a);
+            auto *thenBlock =
+                node<core::Block>(flat.b, Kind::BLOCK);
+            auto *elseBlock = optionalNode<core::Block>(
+                flat.c,
+                Kind::BLOCK
+            );
+
+            return make_with_pos<core::IfStmt>(
+                position,
+                cond,
+                thenBlock,
+                elseBlock
+            );
+        }
+        case Kind::FOR: {
+            if (flat.b != 4) {
+                return fail();
+            }
+
+            core::FlatTree::Children ids =
+                list(flat.a, flat.b);
+
+            if (mHasError) {
+                return nullptr;
+            }
+
+            auto *decl = optionalNode<core::VariableDecl>(
+                ids[0],
+                Kind::VARIABLE_DECL
+            );
+            core::Expr *cond = expr(ids[1]);
+            auto *assignment =
+                optionalNode<core::Assignment>(
+                    ids[2],
+                    Kind::ASSIGNMENT
+                );
+            auto *block =
+                node<core::Block>(ids[3], Kind::BLOCK);
+
+            return make_with_pos<core::ForStmt>(
+                position,
+                decl,
+                cond,
+                assignment,
+                block
+            );
+        }
+        case Kind::WHILE: {
+            core::Expr *cond = expr(flat.a);
+            auto *block =
+                node<core::Block>(flat.b, Kind::BLOCK);
+
+            return make_with_pos<core::WhileStmt>(
+                position,
+                cond,
+                block
+            );
+        }
+        case Kind::RETURN:
+            return make_with_pos<core::ReturnStmt>(
+                position,
+                expr(flat.a)
+            );
+        case Kind::PROGRAM:
+            return make_with_pos<core::Program>(
+                position,
+                stmts(list(flat.a, flat.b))
+            );
+        default:
+            return fail();
+    }
+
+    if (flat.cast != NO_NODE) {
+        built->type =
+            node<core::Type>(flat.cast, Kind::TYPE);
+    }
+
+    return built;
+}
+
+bool Unflattener::claim(core::NodeId id) {
+    if (mHasError || id >= mTree.size() || mClaimed[id]) {
+        return false;
+    }
+
+    mClaimed[id] = true;
+
+    return true;
+}
+
+core::FlatTree::Children Unflattener::list(
+    uint32_t start,
+    uint32_t length
+) {
+    if (uint64_t{start} + length > mTree.lists().size()) {
+        fail();
+
+        return mTree.list(0, 0);
+    }
+
+    return mTree.list(start, length);
+}
+
+core::Atom Unflattener::atom(uint32_t id) {
+    if (id >= mAtoms.size()) {
+        fail();
+
+        return core::Atom{0};
+    }
+
+    return mAtoms[id];
+}
+
+std::nullptr_t Unflattener::fail() {
+    mHasError = true;
+
+    return nullptr;
+}
+
+}  // namespace PArL
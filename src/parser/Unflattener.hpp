@@ -0,0 +1,88 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// parl
+#include <parl/AST.hpp>
+#include <parl/Arena.hpp>
+#include <parl/FlatAST.hpp>
+
+namespace PArL {
+
+// NOTE: rebuilds the node hierarchy out of a flat tree,
+// e.g. one read from an ast file, so it does the opposite
+// of the FlatEmitter. Every node is made again in a new
+// arena, as the passes still visit statements through the
+// hierarchy. The tree is not trusted, every node is checked
+// to be of a kind which may appear where it is used, and to
+// be used at most once, so a malformed tree is rejected
+// rather than built into a cycle.
+
+class Unflattener {
+   public:
+    Unflattener(
+        core::FlatTree tree,
+        std::vector<core::Atom> const &atoms
+    );
+
+    // returns nothing when the tree is malformed, otherwise
+    // the tree keeps the flat tree, with its atoms changed
+    // to the ones they stand for
+    std::optional<core::Tree> unflatten();
+
+   private:
+    template <typename T, typename... Args>
+    T *make_with_pos(core::Position pos, Args &&...args) {
+        T *node =
+            mArena->make<T>(std::forward<Args>(args)...);
+
+        node->position = pos;
+
+        return node;
+    }
+
+    template <typename T>
+    T *node(core::NodeId id, core::FlatTree::Kind kind);
+    template <typename T>
+    T *optionalNode(
+        core::NodeId id,
+        core::FlatTree::Kind kind
+    );
+
+    core::Expr *expr(core::NodeId id);
+    core::Expr *optionalExpr(core::NodeId id);
+    core::Stmt *stmt(core::NodeId id);
+
+    std::vector<core::Expr *> exprs(
+        core::FlatTree::Children ids
+    );
+    std::vector<core::Stmt *> stmts(
+        core::FlatTree::Children ids
+    );
+
+    core::Node *build(core::NodeId id);
+    core::Node *buildNode(core::NodeId id);
+
+    bool claim(core::NodeId id);
+    core::FlatTree::Children list(
+        uint32_t start,
+        uint32_t length
+    );
+    core::Atom atom(uint32_t id);
+
+    std::nullptr_t fail();
+
+    core::FlatTree mTree;
+    std::vector<core::Atom> const &mAtoms;
+
+    std::unique_ptr<core::Arena> mArena{};
+    std::vector<bool> mClaimed{};
+    bool mHasError{false};
+};
+
+}  // namespace PArL
@@ -2,51 +2,18 @@
 
 // parl
 #include <parl/AST.hpp>
-#include <parl/Visitor.hpp>
+#include <parl/StaticVisitor.hpp>
 
 namespace PArL {
 
-class IsFunctionVisitor : public core::Visitor {
+class IsFunctionVisitor
+    : public core::StaticVisitor<IsFunctionVisitor, bool> {
    public:
-    void visit(core::Type *) override;
-    void visit(core::Expr *) override;
-    void visit(core::PadWidth *) override;
-    void visit(core::PadHeight *) override;
-    void visit(core::PadRead *) override;
-    void visit(core::PadRandomInt *) override;
-    void visit(core::BooleanLiteral *) override;
-    void visit(core::IntegerLiteral *) override;
-    void visit(core::FloatLiteral *) override;
-    void visit(core::ColorLiteral *) override;
-    void visit(core::ArrayLiteral *) override;
-    void visit(core::Variable *) override;
-    void visit(core::ArrayAccess *) override;
-    void visit(core::FunctionCall *) override;
-    void visit(core::SubExpr *) override;
-    void visit(core::Binary *) override;
-    void visit(core::Unary *) override;
-    void visit(core::Assignment *) override;
-    void visit(core::VariableDecl *) override;
-    void visit(core::PrintStmt *) override;
-    void visit(core::DelayStmt *) override;
-    void visit(core::WriteBoxStmt *) override;
-    void visit(core::WriteStmt *) override;
-    void visit(core::ClearStmt *) override;
-    void visit(core::Block *) override;
-    void visit(core::FormalParam *) override;
-    void visit(core::FunctionDecl *) override;
-    void visit(core::IfStmt *) override;
-    void visit(core::ForStmt *) override;
-    void visit(core::WhileStmt *) override;
-    void visit(core::ReturnStmt *) override;
-    void visit(core::Program *) override;
+    using StaticVisitor::visit;
 
-    void reset() override;
+    bool visit(core::FunctionDecl *);
 
     bool check(core::Node *node);
-
-   private:
-    bool mReturn{false};
 };
 
 }  // namespace PArL
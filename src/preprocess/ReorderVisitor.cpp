@@ -4,6 +4,7 @@
 
 // parl
 #include <parl/AST.hpp>
+#include <parl/Stack.hpp>
 #include <preprocess/ReorderVisitor.hpp>
 
 // std
@@ -126,24 +127,24 @@ void ReorderVisitor::visit(core::Program *prog) {
 }
 
 void ReorderVisitor::reorder(
-    std::vector<std::unique_ptr<core::Stmt>> &stmts
+    std::vector<core::Stmt *> &stmts
 ) {
     for (auto &stmt : stmts) {
-        if (isFunction.check(stmt.get())) {
-            mFuncQueue.push_back(std::move(stmt));
+        if (isFunction.check(stmt)) {
+            mFuncQueue.push_back(stmt);
         } else {
-            mStmtQueue.push_back(std::move(stmt));
+            mStmtQueue.push_back(stmt);
         }
     }
 
     stmts.clear();
 
     for (auto &stmt : mFuncQueue) {
-        stmts.push_back(std::move(stmt));
+        stmts.push_back(stmt);
     }
 
     for (auto &stmt : mStmtQueue) {
-        stmts.push_back(std::move(stmt));
+        stmts.push_back(stmt);
     }
 
     reset();
@@ -178,7 +179,9 @@ void ReorderVisitor::reorderEnvironment(Environment *env) {
     reset();
 
     for (auto &childEnv : children) {
-        reorderEnvironment(childEnv.get());
+        core::ensureStack([&] {
+            reorderEnvironment(childEnv.get());
+        });
     }
 }
 
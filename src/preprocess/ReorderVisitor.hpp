@@ -50,7 +50,7 @@ class ReorderVisitor : public core::Visitor {
     void reset() override;
 
     void reorder(
-        std::vector<std::unique_ptr<core::Stmt>> &stmts
+        std::vector<core::Stmt *> &stmts
     );
 
     void reorderAst(core::Program *);
@@ -59,8 +59,8 @@ class ReorderVisitor : public core::Visitor {
 
    private:
     IsFunctionVisitor isFunction{};
-    std::deque<std::unique_ptr<core::Stmt>> mFuncQueue{};
-    std::deque<std::unique_ptr<core::Stmt>> mStmtQueue{};
+    std::deque<core::Stmt *> mFuncQueue{};
+    std::deque<core::Stmt *> mStmtQueue{};
     std::deque<std::unique_ptr<Environment>> mFuncEnvQueue{
     };
     std::deque<std::unique_ptr<Environment>> mOtherEnvQueue{
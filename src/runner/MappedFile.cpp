@@ -0,0 +1,86 @@
+// std
+#include <utility>
+
+// unix
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// parl
+#include <runner/MappedFile.hpp>
+
+namespace PArL {
+
+MappedFile::MappedFile(void* data, size_t size)
+    : mData(data), mSize(size) {
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mData(std::exchange(other.mData, nullptr)),
+      mSize(std::exchange(other.mSize, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other
+) noexcept {
+    if (this != &other) {
+        if (mData != nullptr)
+            munmap(mData, mSize);
+
+        mData = std::exchange(other.mData, nullptr);
+        mSize = std::exchange(other.mSize, 0);
+    }
+
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    if (mData != nullptr)
+        munmap(mData, mSize);
+}
+
+std::optional<MappedFile> MappedFile::open(
+    std::string const& path
+) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1)
+        return {};
+
+    struct stat info {};
+
+    if (fstat(fd, &info) == -1 || !S_ISREG(info.st_mode)) {
+        close(fd);
+
+        return {};
+    }
+
+    auto size = static_cast<size_t>(info.st_size);
+
+    // an empty file cannot be mapped, but there is nothing
+    // to map either
+    if (size == 0) {
+        close(fd);
+
+        return MappedFile{nullptr, 0};
+    }
+
+    void* data =
+        mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // the mapping stays valid once the descriptor is closed
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return {};
+
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    return MappedFile{data, size};
+}
+
+std::string_view MappedFile::view() const {
+    return {static_cast<char const*>(mData), mSize};
+}
+
+}  // namespace PArL
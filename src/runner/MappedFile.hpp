@@ -0,0 +1,40 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace PArL {
+
+// NOTE: a read-only mapping of a regular file. The lexer
+// scans the mapping directly, so the source is never
+// copied into memory owned by the compiler.
+
+class MappedFile {
+   public:
+    // returns nothing when the file cannot be mapped, e.g.
+    // it is a pipe, in which case it should be read instead
+    static std::optional<MappedFile> open(
+        std::string const& path
+    );
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    ~MappedFile();
+
+    [[nodiscard]] std::string_view view() const;
+
+   private:
+    MappedFile(void* data, size_t size);
+
+    void* mData = nullptr;
+    size_t mSize = 0;
+};
+
+}  // namespace PArL
@@ -4,14 +4,21 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <utility>
 
 // parl
 #include <ir_gen/GenVisitor.hpp>
 #include <lexer/LexerDirector.hpp>
+#include <parl/AstFile.hpp>
 #include <parl/Token.hpp>
+#include <parser/FlatPrinter.hpp>
 #include <parser/Parser.hpp>
 #include <parser/PrinterVisitor.hpp>
+#include <parser/Unflattener.hpp>
 #include <preprocess/ReorderVisitor.hpp>
+#include <runner/MappedFile.hpp>
 #include <runner/Runner.hpp>
 
 // fmt
@@ -19,12 +26,31 @@
 
 namespace PArL {
 
-Runner::Runner(bool dfsaDbg, bool lexerDbg, bool parserDbg)
+Runner::Runner(
+    bool dfsaDbg,
+    bool lexerDbg,
+    bool parserDbg,
+    bool flatDbg,
+    Parser::Mode parserMode,
+    size_t lexerThreads,
+    bool lazyBodies,
+    size_t parserThreads,
+    std::string astPath
+)
     : mDfsaDbg(dfsaDbg),
       mLexerDbg(lexerDbg),
       mParserDbg(parserDbg),
+      mFlatDbg(flatDbg),
+      mParserThreads(parserThreads),
+      mAstPath(std::move(astPath)),
       mLexer(LexerDirector::buildLexer()),
       mParser(Parser(mLexer)) {
+    mLexer.setInterner(&mInterner);
+
+    mParser.setMode(parserMode);
+    mParser.setLexerThreads(lexerThreads);
+    mParser.setLazyBodies(lazyBodies);
+    mParser.setParserThreads(parserThreads);
 }
 
 // static inline size_t intStringLen(size_t integer) {
@@ -75,19 +101,22 @@ Runner::Runner(bool dfsaDbg, bool lexerDbg, bool parserDbg)
 // fmt::print("\n");
 // }
 
-void Runner::debugLexeing(std::string const& source) {
+void Runner::debugLexeing(std::string_view source) {
     fmt::println("Lexer Debug Print");
 
+    mLexer.setMode(Lexer::Mode::PRESERVE_TRIVIA);
     mLexer.addSource(source);
 
+    core::LineMap const& lineMap = mLexer.getLineMap();
+
     for (;;) {
         std::optional<Token> token = mLexer.nextToken();
 
         if (token.has_value()) {
             fmt::println(
                 "{}:{} {}",
-                token->getPosition().row(),
-                token->getPosition().col(),
+                lineMap.row(token->getPosition()),
+                lineMap.col(token->getPosition()),
                 token->toString()
             );
 
@@ -99,34 +128,110 @@ void Runner::debugLexeing(std::string const& source) {
     }
 
     mLexer.reset();
+    mLexer.setMode(Lexer::Mode::SKIP_TRIVIA);
 }
 
 void Runner::debugParsing(core::Program* program) {
     fmt::println("Parser Debug Print");
 
-    PrinterVisitor printer;
+    PrinterVisitor printer{mInterner};
 
     program->accept(&printer);
 }
 
-void Runner::run(std::string const& source) {
+void Runner::debugFlattening(core::FlatTree const& tree) {
+    fmt::println("Flat Parser Debug Print");
+
+    FlatPrinter printer{tree, mInterner};
+
+    printer.print();
+}
+
+void Runner::run(std::string_view source) {
     if (mLexerDbg) {
         debugLexeing(source);
     }
 
     mParser.parse(source);
 
+    compile();
+}
+
+void Runner::run(std::istream& stream) {
+    // debugging the lexer requires two passes over the
+    // source, so in that case the stream is read in full
+    if (mLexerDbg) {
+        std::string source{
+            std::istreambuf_iterator<char>(stream),
+            std::istreambuf_iterator<char>()
+        };
+
+        run(source);
+
+        return;
+    }
+
+    mParser.parse(stream);
+
+    compile();
+}
+
+void Runner::compile() {
+    // the debug prints and a saved ast need every body, as
+    // do worker threads to be of any use, otherwise a lazy
+    // parser leaves each body for the analysis to ask for.
+    // A parsing error ends the compilation, but the errors in
+    // the bodies are reported with it, as they would have
+    // been had nothing been left for later.
+    if (mParserDbg || mFlatDbg || !mAstPath.empty() ||
+        mParserThreads > 1 || mParser.hasError()) {
+        mParser.parseBodies();
+    }
+
     if (mLexer.hasError() || mParser.hasError()) {
         return;
     }
 
-    std::unique_ptr<core::Program> ast = mParser.getAst();
+    core::Tree ast = mParser.getLazyAst();
+
+    if (mFlatDbg) {
+        debugFlattening(ast.flat());
+    }
 
+    if (!mAstPath.empty()) {
+        saveAst(ast.flat());
+    }
+
+    compile(ast, mLexer.getLineMap());
+}
+
+void Runner::compile(
+    core::Tree const& ast,
+    core::LineMap const& lineMap
+) {
     if (mParserDbg) {
         debugParsing(ast.get());
     }
 
-    mAnalyser.analyse(ast.get());
+    mAnalyser.analyse(
+        ast,
+        lineMap,
+        mInterner,
+        [this](core::FunctionDecl* decl) {
+            mParser.parseBody(decl);
+
+            return decl->block != nullptr;
+        }
+    );
+
+    // the analysis stopped at a body which did not parse,
+    // the bodies it did not get to are parsed for their
+    // errors, which are all that is reported
+    if (mParser.hasError()) {
+        mParser.parseBodies();
+
+        return;
+    }
 
     if (mAnalyser.hasError()) {
         return;
@@ -145,54 +250,83 @@ void Runner::run(std::string const& source) {
 
     reorder.reorderEnvironment(environment.get());
 
-    GenVisitor gen{environment.get()};
+    GenVisitor gen{
+        environment.get(),
+        ast.flat(),
+        mInterner
+    };
 
     ast->accept(&gen);
 
     gen.print();
 }
 
-int Runner::runFile(std::string& path) {
+void Runner::saveAst(core::FlatTree const& tree) {
+    std::ofstream file(mAstPath, std::ofstream::binary);
+
+    // the ast is only saved to spare later runs, so the
+    // program is still compiled if it cannot be
+    if (!file || !core::AstFile::write(
+                     file,
+                     tree,
+                     mInterner,
+                     mLexer.getLineMap()
+                 )) {
+        fmt::println(
+            stderr,
+            "parl: cannot save the ast to {}",
+            mAstPath
+        );
+    }
+}
+
+static bool checkPath(std::string& path) {
     std::filesystem::path fsPath{path};
 
     if (!std::filesystem::exists(fsPath)) {
         fmt::println(stderr, "parl: path does not exist");
 
-        return EXIT_FAILURE;
+        return false;
     }
 
-    if (!std::filesystem::is_regular_file(fsPath)) {
-        fmt::println(
-            stderr,
-            "parl: path is not a regular file"
-        );
+    if (std::filesystem::is_directory(fsPath)) {
+        fmt::println(stderr, "parl: path is a directory");
 
-        return EXIT_FAILURE;
+        return false;
     }
 
-    std::ifstream file(path);
-
-    // make sure the file is opened correctly
-    if (!file) {
-        fmt::println(stderr, "parl: {}", strerror(errno));
+    return true;
+}
 
+int Runner::runFile(std::string& path) {
+    if (!checkPath(path)) {
         return EXIT_FAILURE;
     }
 
-    // get the length of the file
-    file.seekg(0, std::ifstream::end);
-    auto length = file.tellg();
-    file.seekg(0, std::ifstream::beg);
+    // regular files are mapped and lexed in place, anything
+    // else, such as a pipe, is read in chunks instead
+    if (std::optional<MappedFile> mapped =
+            MappedFile::open(path)) {
+        run(mapped->view());
+    } else {
+        std::ifstream file(path, std::ifstream::binary);
 
-    // load the source file into a string
-    std::string source(length, '\0');
-    file.read(source.data(), length);
+        // make sure the file is opened correctly
+        if (!file) {
+            fmt::println(
+                stderr,
+                "parl: {}",
+                strerror(errno)
+            );
 
-    // close file
-    file.close();
+            return EXIT_FAILURE;
+        }
 
-    // run the source file
-    run(source);
+        run(file);
+
+        // close file
+        file.close();
+    }
 
     if (mHadLexingError || mHadParsingError)
         return 65;
@@ -200,6 +334,73 @@ int Runner::runFile(std::string& path) {
     return 0;
 }
 
+int Runner::loadFile(std::string& path) {
+    if (!checkPath(path)) {
+        return EXIT_FAILURE;
+    }
+
+    std::optional<MappedFile> mapped =
+        MappedFile::open(path);
+    std::string contents{};
+
+    // an ast file is laid out to be mapped, but anything
+    // which cannot be is read in full instead
+    if (!mapped.has_value()) {
+        std::ifstream file(path, std::ifstream::binary);
+
+        if (!file) {
+            fmt::println(
+                stderr,
+                "parl: {}",
+                strerror(errno)
+            );
+
+            return EXIT_FAILURE;
+        }
+
+        contents.assign(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        );
+    }
+
+    std::optional<core::AstFile> file = core::AstFile::read(
+        mapped.has_value() ? mapped->view() : contents,
+        mInterner
+    );
+
+    std::optional<core::Tree> ast{};
+
+    // the file spares the parse, but the tree is rebuilt and
+    // checked node by node before it is compiled
+    if (file.has_value()) {
+        Unflattener unflattener{
+            file->takeTree(),
+            file->atoms()
+        };
+
+        ast = unflattener.unflatten();
+    }
+
+    if (!ast.has_value()) {
+        fmt::println(
+            stderr,
+            "parl: {} is not an ast file which can be read",
+            path
+        );
+
+        return EXIT_FAILURE;
+    }
+
+    if (mFlatDbg) {
+        debugFlattening(ast->flat());
+    }
+
+    compile(*ast, file->lineMap());
+
+    return 0;
+}
+
 int Runner::runPrompt() {
     std::string line;
 
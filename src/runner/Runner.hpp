@@ -1,11 +1,14 @@
 #pragma once
 
 // std
+#include <istream>
 #include <string>
+#include <string_view>
 
 // parl
 #include <analysis/AnalysisVisitor.hpp>
 #include <lexer/Lexer.hpp>
+#include <parl/Interner.hpp>
 #include <parl/Token.hpp>
 #include <parser/Parser.hpp>
 
@@ -13,17 +16,40 @@ namespace PArL {
 
 class Runner {
    public:
-    Runner(bool dfsaDbg, bool lexerDbg, bool parserDbg);
+    Runner(
+        bool dfsaDbg,
+        bool lexerDbg,
+        bool parserDbg,
+        bool flatDbg,
+        Parser::Mode parserMode = Parser::Mode::WINDOWED,
+        size_t lexerThreads = 1,
+        bool lazyBodies = false,
+        size_t parserThreads = 1,
+        std::string astPath = {}
+    );
 
     int runFile(std::string& path);
+    // runs an ast file saved by an earlier run, the source
+    // it was parsed from is neither lexed nor parsed again
+    int loadFile(std::string& path);
     int runPrompt();
 
     void debugDfsa();
-    void debugLexeing(std::string const& source);
+    void debugLexeing(std::string_view source);
     void debugParsing(core::Program* program);
+    void debugFlattening(core::FlatTree const& tree);
 
    private:
-    void run(std::string const& source);
+    void run(std::string_view source);
+    void run(std::istream& stream);
+
+    void compile();
+    void compile(
+        core::Tree const& ast,
+        core::LineMap const& lineMap
+    );
+
+    void saveAst(core::FlatTree const& tree);
 
     bool mHadLexingError = false;
     bool mHadParsingError = false;
@@ -32,6 +58,15 @@ class Runner {
     bool mDfsaDbg = false;
     bool mLexerDbg = false;
     bool mParserDbg = false;
+    bool mFlatDbg = false;
+
+    // bodies are only parsed in parallel all at once
+    size_t mParserThreads = 1;
+
+    // where the parsed ast is saved, if anywhere
+    std::string mAstPath{};
+
+    core::Interner mInterner;
 
     Lexer mLexer;
     Parser mParser;